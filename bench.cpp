@@ -0,0 +1,664 @@
+#include "awgn.h"
+#include "batch.h"
+#ifdef XT_EX_CUDA
+#include "batchgpu.h"
+#endif
+#include "bitvec.h"
+#include "blind.h"
+#include "crc.h"
+#include "encdl.h"
+#include "ex1.h"
+#include "gf2.h"
+#include "ofdm.h"
+#include "pattern.h"
+#include "plan.h"
+#include "polar.h"
+#include "ratematch.h"
+#include "simd.h"
+#include "svc.h"
+#include "tvload.h"
+#include <benchmark/benchmark.h>
+#include <complex>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <xtensor-blas/xlinalg.hpp>
+#include <xtensor/xadapt.hpp>
+#include <xtensor/xarray.hpp>
+#include <xtensor/xbuilder.hpp>
+#include <xtensor/xcomplex.hpp>
+#include <xtensor/xcsv.hpp>
+#include <xtensor/xindex_view.hpp>
+#include <xtensor/xoperation.hpp>
+#include <xtensor/xrandom.hpp>
+
+/** Microbenchmarks
+
+Every stage of the downlink chain in its reference (xtensor) and fast (packed) form,
+on the configurations of the test vectors dl/tv0, dl/tv1 and dl/tv2. Inputs are random,
+so no test vector files are needed. The first argument selects the configuration, the
+second the number of codewords B encoded per iteration, each with its own input.
+
+Counters: t/cw is the time per codeword (e.g. 104ns) and bits the info bit throughput
+(e.g. 12M/s for 12 Mbit/s).
+*/
+
+// Configurations of the test vectors
+static const params_s BENCH_TV[] = {
+    {12, 24, 36, 48, 64, LINK_DL},
+    {65, 24, 89, 184, 256, LINK_DL},
+    {134, 24, 158, 267, 512, LINK_DL},
+};
+
+// Random inputs of B codewords
+typedef struct benchIn_s {
+    std::shared_ptr<const plan_s> plan;
+    int B;
+    int nInfoWords;
+    std::vector<uint64_t> info; // B rows of nInfoWords
+    std::vector<uint16_t> rnti;
+    std::vector<xt::xarray<int>> infoBits; // Same info bits unpacked
+} benchIn_s;
+
+static benchIn_s benchInput(const benchmark::State &state) {
+    benchIn_s in;
+    const params_s *params = &BENCH_TV[state.range(0)];
+    in.plan = planGet(planCacheDefault(), params);
+    in.B = state.range(1);
+    in.nInfoWords = bvWords(params->A);
+    in.info.resize(in.B * in.nInfoWords);
+    in.rnti.resize(in.B);
+
+    std::mt19937_64 rng(0x5eed + state.range(0));
+    for (int b = 0; b < in.B; ++b) {
+        xt::xarray<int> bits = xt::zeros<int>({params->A});
+        for (int i = 0; i < params->A; ++i)
+            bits(i) = rng() & 1;
+        bitvec_s packed;
+        bvPack(&packed, bits.data(), params->A);
+        std::copy(packed.words.begin(), packed.words.end(),
+                  in.info.begin() + b * in.nInfoWords);
+        in.rnti[b] = uint16_t(rng());
+        in.infoBits.push_back(bits);
+    }
+    return in;
+}
+
+static void benchCounters(benchmark::State &state, const benchIn_s *in) {
+    double nCw = double(in->B);
+    state.counters["t/cw"] = benchmark::Counter(
+        nCw, benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+    state.counters["bits"] = benchmark::Counter(
+        nCw * in->plan->params.A, benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// CRC generator matrix, K x P: row i is the CRC of input bit i of L ones and A info
+// bits, as read from crc_gen_m.txt by the GEMM path
+static xt::xarray<int> benchCrcMtx(const plan_s *plan) {
+    int K = plan->params.K, P = plan->params.P;
+    xt::xarray<int> mtx = xt::zeros<int>({K, P});
+    std::vector<uint64_t> unit(bvWords(K));
+    for (int i = 0; i < K; ++i) {
+        std::fill(unit.begin(), unit.end(), 0);
+        unit[i >> 6] = uint64_t{1} << (i & 63);
+        uint32_t reg = crcUpdateTable(plan->crc, 0, unit.data(), K);
+        for (int j = 0; j < P; ++j)
+            mtx(i, j) = (reg >> j) & 1;
+    }
+    return mtx;
+}
+
+// Polar generator matrix F^{(x)n}, N x N, as read from enc_gen_m.txt
+static xt::xarray<int> benchEncMtx(int N) {
+    xt::xarray<int> mtx = xt::zeros<int>({N, N});
+    for (int i = 0; i < N; ++i)
+        for (int j = 0; j < N; ++j)
+            mtx(i, j) = (i & j) == j;
+    return mtx;
+}
+
+// Bits of the u-vector of each codeword, unpacked
+static std::vector<xt::xarray<int>> benchUBits(const benchIn_s *in) {
+    const params_s *p = &in->plan->params;
+    std::vector<xt::xarray<int>> uBits;
+    bitvec_s u;
+    bvInit(&u, p->N);
+    for (int b = 0; b < in->B; ++b) {
+        planFrozenInsert(in->plan.get(), &in->info[b * in->nInfoWords], in->rnti[b],
+                         u.words.data());
+        xt::xarray<int> bits = xt::zeros<int>({p->N});
+        bvUnpack(&u, bits.data());
+        uBits.push_back(bits);
+    }
+    return uBits;
+}
+
+// CRC
+
+static void BM_CrcMatrix(benchmark::State &state) {
+    benchIn_s in = benchInput(state);
+    const params_s *p = &in.plan->params;
+    xt::xarray<int> crcMtx = benchCrcMtx(in.plan.get());
+    xt::xarray<int> ones = xt::ones<int>({p->P});
+    xt::xarray<int> crcBits;
+    for (auto _ : state)
+        for (int b = 0; b < in.B; ++b) {
+            crcBits = xt::linalg::dot(
+                xt::concatenate(xt::xtuple(ones, in.infoBits[b])), crcMtx);
+            crcBits %= 2;
+            benchmark::DoNotOptimize(crcBits.data());
+        }
+    benchCounters(state, &in);
+}
+
+// Same matrix packed, Four Russians tables: one row XOR per 8 message bits
+static void BM_CrcGf2(benchmark::State &state) {
+    benchIn_s in = benchInput(state);
+    const params_s *p = &in.plan->params;
+    xt::xarray<int> crcMtx = benchCrcMtx(in.plan.get());
+    gf2Mat_s mtx;
+    gf2FromInt(&mtx, crcMtx.data(), p->K, p->P);
+    gf2M4r_s tab;
+    gf2M4rInit(&tab, &mtx);
+    std::vector<bitvec_s> msg(in.B);
+    bitvec_s ones, info;
+    std::vector<int> onesBits(p->P, 1);
+    bvPack(&ones, onesBits.data(), p->P);
+    for (int b = 0; b < in.B; ++b) {
+        bvPack(&info, in.infoBits[b].data(), p->A);
+        bvConcat(&ones, &info, &msg[b]);
+    }
+    uint64_t crc[1];
+    for (auto _ : state)
+        for (int b = 0; b < in.B; ++b) {
+            gf2M4rVecMat(&tab, msg[b].words.data(), crc);
+            benchmark::DoNotOptimize(crc);
+        }
+    benchCounters(state, &in);
+}
+
+static void BM_CrcTable(benchmark::State &state) {
+    benchIn_s in = benchInput(state);
+    const crcTable_s *tab = in.plan->crc;
+    for (auto _ : state)
+        for (int b = 0; b < in.B; ++b)
+            benchmark::DoNotOptimize(crcUpdateTable(
+                tab, tab->onesInit, &in.info[b * in.nInfoWords], in.plan->params.A));
+    benchCounters(state, &in);
+}
+
+static void BM_CrcClmul(benchmark::State &state) {
+    benchIn_s in = benchInput(state);
+    const crcTable_s *tab = in.plan->crc;
+    if (!crcHasClmul()) {
+        state.SkipWithError("no carry-less multiply");
+        return;
+    }
+    for (auto _ : state)
+        for (int b = 0; b < in.B; ++b)
+            benchmark::DoNotOptimize(crcUpdateClmul(
+                tab, tab->onesInit, &in.info[b * in.nInfoWords], in.plan->params.A));
+    benchCounters(state, &in);
+}
+
+// Polar encoding
+
+static void BM_PolarGemm(benchmark::State &state) {
+    benchIn_s in = benchInput(state);
+    std::vector<xt::xarray<int>> uBits = benchUBits(&in);
+    xt::xarray<int> encMtx = benchEncMtx(in.plan->params.N);
+    xt::xarray<int> encBits;
+    for (auto _ : state)
+        for (int b = 0; b < in.B; ++b) {
+            encBits = xt::linalg::dot(uBits[b], encMtx);
+            encBits %= 2;
+            benchmark::DoNotOptimize(encBits.data());
+        }
+    benchCounters(state, &in);
+}
+
+static void BM_PolarGf2(benchmark::State &state) {
+    benchIn_s in = benchInput(state);
+    int N = in.plan->params.N, nWords = bvWords(N);
+    xt::xarray<int> encMtx = benchEncMtx(N);
+    gf2Mat_s mtx;
+    gf2FromInt(&mtx, encMtx.data(), N, N);
+    gf2M4r_s tab;
+    gf2M4rInit(&tab, &mtx);
+    std::vector<uint64_t> u(in.B * nWords);
+    for (int b = 0; b < in.B; ++b)
+        planFrozenInsert(in.plan.get(), &in.info[b * in.nInfoWords], in.rnti[b],
+                         &u[b * nWords]);
+    uint64_t enc[PLAN_N_MAX / 64];
+    for (auto _ : state)
+        for (int b = 0; b < in.B; ++b) {
+            gf2M4rVecMat(&tab, &u[b * nWords], enc);
+            benchmark::DoNotOptimize(enc);
+        }
+    benchCounters(state, &in);
+}
+
+static void BM_PolarButterfly(benchmark::State &state) {
+    benchIn_s in = benchInput(state);
+    std::vector<xt::xarray<int>> uBits = benchUBits(&in);
+    xt::xarray<int> encBits;
+    for (auto _ : state)
+        for (int b = 0; b < in.B; ++b) {
+            encBits = uBits[b];
+            polarEnc(encBits.data(), in.plan->params.N);
+            benchmark::DoNotOptimize(encBits.data());
+        }
+    benchCounters(state, &in);
+}
+
+static void BM_PolarPacked(benchmark::State &state) {
+    benchIn_s in = benchInput(state);
+    int N = in.plan->params.N, nWords = bvWords(N);
+    std::vector<uint64_t> u(in.B * nWords);
+    for (int b = 0; b < in.B; ++b)
+        planFrozenInsert(in.plan.get(), &in.info[b * in.nInfoWords], in.rnti[b],
+                         &u[b * nWords]);
+    for (auto _ : state)
+        for (int b = 0; b < in.B; ++b) {
+            polarEncPacked(&u[b * nWords], N);
+            benchmark::ClobberMemory();
+        }
+    benchCounters(state, &in);
+}
+
+// CRC attachment, scrambling, CRC interleaving and frozen bit insertion
+
+// Stage by stage as in encDl: table CRC, then index_view and filter on unpacked bits
+static void BM_InsertIndexView(benchmark::State &state) {
+    benchIn_s in = benchInput(state);
+    const plan_s *plan = in.plan.get();
+    const params_s *p = &plan->params;
+    xt::xarray<int> crcIntrl = xt::adapt(plan->crcIntrl);
+    xt::xarray<int> infoMask = xt::zeros<int>({p->N});
+    bvUnpack(&plan->frozenMask, infoMask.data());
+    xt::xarray<int> crcBits = xt::zeros<int>({p->P});
+    xt::xarray<int> infoCrcBits, intrlBits;
+    xt::xarray<int> frozenBits = xt::zeros<int>({p->N});
+    for (auto _ : state)
+        for (int b = 0; b < in.B; ++b) {
+            uint32_t crc = crcUpdate(plan->crc, plan->crc->onesInit,
+                                     &in.info[b * in.nInfoWords], p->A);
+            crc ^= planRntiMask(plan, in.rnti[b]);
+            for (int i = 0; i < p->P; ++i)
+                crcBits(i) = (crc >> i) & 1;
+            infoCrcBits = xt::concatenate(xt::xtuple(in.infoBits[b], crcBits));
+            intrlBits = xt::index_view(infoCrcBits, crcIntrl);
+            xt::filter(frozenBits, infoMask > 0) = intrlBits;
+            benchmark::DoNotOptimize(frozenBits.data());
+        }
+    benchCounters(state, &in);
+}
+
+static void BM_InsertFused(benchmark::State &state) {
+    benchIn_s in = benchInput(state);
+    uint64_t u[PLAN_N_MAX / 64];
+    for (auto _ : state)
+        for (int b = 0; b < in.B; ++b) {
+            planFrozenInsert(in.plan.get(), &in.info[b * in.nInfoWords], in.rnti[b], u);
+            benchmark::DoNotOptimize(u);
+        }
+    benchCounters(state, &in);
+}
+
+// Rate matching
+
+static void BM_RmIndexView(benchmark::State &state) {
+    benchIn_s in = benchInput(state);
+    std::vector<xt::xarray<int>> encBits = benchUBits(&in);
+    xt::xarray<int> rmIdx = xt::adapt(in.plan->rmIdx);
+    xt::xarray<int> rmBits;
+    for (auto _ : state)
+        for (int b = 0; b < in.B; ++b) {
+            rmBits = xt::index_view(encBits[b], rmIdx);
+            benchmark::DoNotOptimize(rmBits.data());
+        }
+    benchCounters(state, &in);
+}
+
+static void BM_RmGather(benchmark::State &state) {
+    benchIn_s in = benchInput(state);
+    const plan_s *plan = in.plan.get();
+    const simdKernels_s *simd = simdGet();
+    int nWords = bvWords(plan->params.N);
+    std::vector<uint64_t> u(in.B * nWords);
+    for (int b = 0; b < in.B; ++b)
+        planFrozenInsert(plan, &in.info[b * in.nInfoWords], in.rnti[b], &u[b * nWords]);
+    uint64_t rm[PLAN_N_MAX / 64];
+    for (auto _ : state)
+        for (int b = 0; b < in.B; ++b) {
+            simd->gatherBits(&u[b * nWords], plan->rmIdx.data(), plan->params.E, rm);
+            benchmark::DoNotOptimize(rm);
+        }
+    benchCounters(state, &in);
+}
+
+static void BM_RmStream(benchmark::State &state) {
+    benchIn_s in = benchInput(state);
+    const plan_s *plan = in.plan.get();
+    int nWords = bvWords(plan->params.N);
+    std::vector<uint64_t> u(in.B * nWords);
+    for (int b = 0; b < in.B; ++b)
+        planFrozenInsert(plan, &in.info[b * in.nInfoWords], in.rnti[b], &u[b * nWords]);
+    uint64_t rm[PLAN_N_MAX / 64];
+    for (auto _ : state)
+        for (int b = 0; b < in.B; ++b) {
+            rmStreamPacked(&plan->rmStream, &u[b * nWords], rm);
+            benchmark::DoNotOptimize(rm);
+        }
+    benchCounters(state, &in);
+}
+
+// Whole chain
+
+static void BM_Encode(benchmark::State &state) {
+    benchIn_s in = benchInput(state);
+    uint64_t rm[PLAN_N_MAX / 64];
+    for (auto _ : state)
+        for (int b = 0; b < in.B; ++b) {
+            planEncode(in.plan.get(), &in.info[b * in.nInfoWords], in.rnti[b], rm);
+            benchmark::DoNotOptimize(rm);
+        }
+    benchCounters(state, &in);
+}
+
+static void BM_EncodeGeneric(benchmark::State &state) {
+    benchIn_s in = benchInput(state);
+    uint64_t rm[PLAN_N_MAX / 64];
+    for (auto _ : state)
+        for (int b = 0; b < in.B; ++b) {
+            planEncodeGeneric(in.plan.get(), &in.info[b * in.nInfoWords], in.rnti[b],
+                              rm);
+            benchmark::DoNotOptimize(rm);
+        }
+    benchCounters(state, &in);
+}
+
+static void BM_EncodeBatch(benchmark::State &state) {
+    benchIn_s in = benchInput(state);
+    std::vector<uint64_t> rm(in.B * bvWords(in.plan->params.E));
+    for (auto _ : state) {
+        batchEncode(in.plan.get(), in.B, in.info.data(), in.rnti.data(), rm.data());
+        benchmark::DoNotOptimize(rm.data());
+    }
+    benchCounters(state, &in);
+}
+
+#ifdef XT_EX_CUDA
+// GPU batch from and into its pinned rows, copies included
+static void BM_EncodeGpu(benchmark::State &state) {
+    benchIn_s in = benchInput(state);
+    if (!batchGpuAvailable()) {
+        state.SkipWithError("no CUDA device");
+        return;
+    }
+    batchGpu_s gpu;
+    batchGpuCreate(&gpu, in.plan, in.B);
+    std::copy(in.info.begin(), in.info.end(), gpu.info);
+    std::copy(in.rnti.begin(), in.rnti.end(), gpu.rnti);
+    for (auto _ : state)
+        batchGpuEncode(&gpu, in.B, gpu.info, gpu.rnti, gpu.rm);
+    batchGpuDestroy(&gpu);
+    benchCounters(state, &in);
+}
+#endif
+
+// Through the encoding service: B requests into the request ring of one worker, all B
+// responses out of the response ring
+static void BM_Service(benchmark::State &state) {
+    benchIn_s in = benchInput(state);
+    svcCfg_s cfg;
+    svcDefaults(&cfg);
+    cfg.nThreads = 1;
+    svc_s svc;
+    svcStart(&svc, &cfg);
+    for (auto _ : state) {
+        for (int b = 0; b < in.B; ++b) {
+            uint64_t pos;
+            void *slot;
+            while (!(slot = ringClaim(&svc.req, &pos)))
+                std::this_thread::yield();
+            auto *req = static_cast<svcReq_s *>(slot);
+            req->id = b;
+            req->deadlineNs = 0;
+            req->slot = 0;
+            req->rnti = in.rnti[b];
+            req->nBytes = SVC_HDR + 8 * in.nInfoWords;
+            req->params = in.plan->params;
+            std::copy_n(&in.info[b * in.nInfoWords], in.nInfoWords, svcInfo(req));
+            ringPublish(&svc.req, pos);
+        }
+        for (int b = 0; b < in.B; ++b) {
+            uint64_t pos;
+            void *slot;
+            while (!(slot = ringAcquire(&svc.rsp, &pos)))
+                std::this_thread::yield();
+            benchmark::DoNotOptimize(svcRm(static_cast<svcRsp_s *>(slot)));
+            ringRelease(&svc.rsp, pos);
+        }
+    }
+    svcStats_s stats;
+    svcStop(&svc, &stats);
+    benchCounters(state, &in);
+}
+
+// Modulation
+
+// QPSK, resource mapping and the batched IFFT of the slot of each codeword
+static void BM_Ofdm(benchmark::State &state) {
+    benchIn_s in = benchInput(state);
+    int E = in.plan->params.E, nWords = bvWords(E);
+    std::vector<uint64_t> rm(in.B * nWords);
+    for (int b = 0; b < in.B; ++b)
+        planEncode(in.plan.get(), &in.info[b * in.nInfoWords], in.rnti[b],
+                   &rm[b * nWords]);
+    ofdmParams_s op;
+    ofdmFit(E, &op);
+    ofdm_s ofdm;
+    ofdmCreate(&ofdm, &op);
+    std::vector<std::complex<float>> samples(op.nSym * (op.nCp + op.nFft));
+    for (auto _ : state)
+        for (int b = 0; b < in.B; ++b) {
+            ofdmModulate(&ofdm, &rm[b * nWords], E, samples.data());
+            benchmark::DoNotOptimize(samples.data());
+        }
+    ofdmDestroy(&ofdm);
+    benchCounters(state, &in);
+}
+
+// Channel noise, first argument the complex samples per call
+
+// As in ex1_cmplx_run: randn into the real and imaginary views of complex<double>
+static void BM_AwgnXt(benchmark::State &state) {
+    int n = state.range(0);
+    xt::xarray<std::complex<double>> a = xt::zeros<std::complex<double>>({n});
+    for (auto _ : state) {
+        xt::real(a) = xt::random::randn({n}, 0.0, 1.0);
+        xt::imag(a) = xt::random::randn({n}, 0.0, 1.0);
+        benchmark::DoNotOptimize(a.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// Philox stream, second argument the instruction set of the kernel
+static void BM_Awgn(benchmark::State &state) {
+    int n = state.range(0);
+    const simdKernels_s *simd = simdFind(simdIsa_e(state.range(1)));
+    if (!simd) {
+        state.SkipWithError("instruction set not supported");
+        return;
+    }
+    awgn_s awgn;
+    awgnInit(&awgn, 0x5eed, 0);
+    std::vector<std::complex<float>> a(n);
+    for (auto _ : state) {
+        simd->gauss(awgn.key, awgn.stream, awgn.ctr, n / 2, 1.0f, (float *)a.data());
+        awgn.ctr += n / 2;
+        benchmark::DoNotOptimize(a.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// PDCCH blind decoding, first argument the list size, second the DCIs to stop
+// at (0 = every candidate), third the threads. Slots of the default search space at
+// 3 dB Es/N0 with one DCI each, items are candidate and DCI size pairs.
+
+static void BM_Blind(benchmark::State &state) {
+    blindCfg_s cfg;
+    blindDefaults(&cfg);
+    cfg.L = state.range(0);
+    cfg.maxHits = state.range(1);
+    cfg.nThreads = state.range(2);
+    blind_s bd;
+    blindCreate(&bd, &cfg);
+    const int nSlots = 20;
+    const int nLlr = cfg.nCce * BLIND_CCE_BITS;
+    std::vector<int16_t> llr(nSlots * nLlr);
+    std::vector<uint16_t> rnti(nSlots);
+    for (int s = 0; s < nSlots; ++s) {
+        rnti[s] = uint16_t(0x4601 + 97 * s);
+        blindHit_s tx;
+        blindTx(&bd, rnti[s], s, 3.0, 0x5eed, &llr[s * nLlr], &tx);
+    }
+    std::vector<blindHit_s> hits;
+    blindStats_s stats{};
+    int s = 0;
+    for (auto _ : state) {
+        blindSearch(&bd, &llr[s * nLlr], rnti[s], s, &hits, &stats);
+        s = (s + 1) % nSlots;
+    }
+    state.SetItemsProcessed(stats.nDecodes);
+    state.counters["list"] = double(stats.nList) / stats.nDecodes;
+    state.counters["hits"] = double(stats.nHits) / state.iterations();
+    blindDestroy(&bd);
+}
+
+// Test vector text, first argument the lines of 0 / 1 tokens as in enc_gen_m.txt
+
+static std::string benchBitText(int n) {
+    std::mt19937 rng(0x5eed);
+    std::string text;
+    for (int i = 0; i < n; ++i) {
+        text += char('0' + (rng() & 1));
+        text += '\n';
+    }
+    return text;
+}
+
+// As readBits did: xt::load_csv on a stream
+static void BM_TextCsv(benchmark::State &state) {
+    std::string text = benchBitText(state.range(0));
+    for (auto _ : state) {
+        std::istringstream in(text);
+        xt::xarray<int> bits = xt::load_csv<int>(in);
+        benchmark::DoNotOptimize(bits.data());
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+// Packed straight from the text, second argument the instruction set of the kernel
+static void BM_TextBits(benchmark::State &state) {
+    std::string text = benchBitText(state.range(0));
+    const simdKernels_s *simd = simdFind(simdIsa_e(state.range(1)));
+    if (!simd) {
+        state.SkipWithError("instruction set not supported");
+        return;
+    }
+    std::vector<uint64_t> words(bvWords(text.size() / 2 + 1));
+    for (auto _ : state) {
+        int64_t n = simd->textBits(text.data(), text.size(), words.data());
+        benchmark::DoNotOptimize(n);
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+// Baselines of the ex1 examples
+
+// ex2_crc_run: one 32 x 32 CRC matrix step on the tv0 message
+static void BM_Ex2Crc(benchmark::State &state) {
+    xt::xarray<int> crcMtx = ex2_crc_mtx();
+    std::mt19937_64 rng(0x5eed);
+    xt::xarray<int> msg = xt::zeros<int>({BENCH_TV[0].A});
+    for (auto &bit : msg)
+        bit = rng() & 1;
+    for (auto _ : state) {
+        xt::xarray<int> crc = ex2_crc(crcMtx, msg);
+        benchmark::DoNotOptimize(crc.data());
+    }
+}
+
+// ex2_cmplx_run: FFT and fftshift of 8 complex samples
+static void BM_Ex2Cmplx(benchmark::State &state) {
+    std::mt19937_64 rng(0x5eed);
+    std::normal_distribution<double> randn;
+    xt::xarray<std::complex<double>> a = xt::zeros<std::complex<double>>({8});
+    for (auto &x : a)
+        x = {randn(rng), randn(rng)};
+    for (auto _ : state) {
+        xt::xarray<std::complex<double>> spec = ex2_cmplx(a);
+        benchmark::DoNotOptimize(spec.data());
+    }
+}
+
+// All configurations with B of 1 and 64, larger batches for the whole chain
+static void benchArgs(benchmark::internal::Benchmark *b) {
+    for (int tv = 0; tv < 3; ++tv)
+        for (int B : {1, 64})
+            b->Args({tv, B});
+}
+
+static void benchArgsBatch(benchmark::internal::Benchmark *b) {
+    for (int tv = 0; tv < 3; ++tv)
+        for (int B : {1, 8, 64, 256})
+            b->Args({tv, B});
+}
+
+BENCHMARK(BM_CrcMatrix)->Apply(benchArgs);
+BENCHMARK(BM_CrcGf2)->Apply(benchArgs);
+BENCHMARK(BM_CrcTable)->Apply(benchArgs);
+BENCHMARK(BM_CrcClmul)->Apply(benchArgs);
+BENCHMARK(BM_PolarGemm)->Apply(benchArgs);
+BENCHMARK(BM_PolarGf2)->Apply(benchArgs);
+BENCHMARK(BM_PolarButterfly)->Apply(benchArgs);
+BENCHMARK(BM_PolarPacked)->Apply(benchArgs);
+BENCHMARK(BM_InsertIndexView)->Apply(benchArgs);
+BENCHMARK(BM_InsertFused)->Apply(benchArgs);
+BENCHMARK(BM_RmIndexView)->Apply(benchArgs);
+BENCHMARK(BM_RmGather)->Apply(benchArgs);
+BENCHMARK(BM_RmStream)->Apply(benchArgs);
+BENCHMARK(BM_Encode)->Apply(benchArgsBatch);
+BENCHMARK(BM_EncodeGeneric)->Apply(benchArgsBatch);
+BENCHMARK(BM_EncodeBatch)->Apply(benchArgsBatch);
+#ifdef XT_EX_CUDA
+BENCHMARK(BM_EncodeGpu)->ArgsProduct({{0, 1, 2}, {1024, 16384}});
+#endif
+BENCHMARK(BM_Service)->Apply(benchArgsBatch);
+BENCHMARK(BM_Ofdm)->Apply(benchArgs);
+BENCHMARK(BM_AwgnXt)->Arg(1024);
+BENCHMARK(BM_Awgn)
+    ->Args({1024, SIMD_SCALAR})
+    ->Args({1024, SIMD_AVX2})
+    ->Args({1024, SIMD_NEON});
+BENCHMARK(BM_Blind)
+    ->Args({1, 1, 1})
+    ->Args({DEC_L_MAX, 0, 1})
+    ->Args({DEC_L_MAX, 1, 1})
+    ->Args({DEC_L_MAX, 1, 0})
+    ->UseRealTime();
+BENCHMARK(BM_TextCsv)->Arg(512 * 512);
+BENCHMARK(BM_TextBits)
+    ->Args({512 * 512, SIMD_SCALAR})
+    ->Args({512 * 512, SIMD_AVX2})
+    ->Args({512 * 512, SIMD_NEON});
+BENCHMARK(BM_Ex2Crc);
+BENCHMARK(BM_Ex2Cmplx);
+
+BENCHMARK_MAIN();
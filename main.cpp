@@ -1,54 +1,230 @@
+#ifdef XT_EX_CUDA
+#include "batchgpu.h"
+#endif
+#include "blind.h"
+#include "decdl.h"
 #include "encdl.h"
-#include "ex1.h"
+#include "ofdm.h"
+#include "polarcfg.h"
+#include "prof.h"
+#include "runner.h"
+#include "sim.h"
+#include "svc.h"
+#include "trace.h"
+#include "tvbin.h"
+#include "tvload.h"
 #include "util.h"
+#include <cstdio>
 #include <cstdlib>
 #include <filesystem>
 #include <iostream>
+#include <string>
+#include <vector>
 
 namespace fs = std::filesystem;
 
+static const char *mainUsage =
+    "usage: xt_ex <command> [options] [<dir | glob | manifest>...]\n"
+    "  run [-jN]                       encode test vectors, check their rm_bits\n"
+    "  sim [-jN] [-lL] [-q] [-eFROM:TO:STEP] [-bBLOCKS] [-tERRORS]\n"
+    "                                  BLER sweep, CSV on stdout\n"
+    "  load [-jN]                      corpus load rate\n"
+    "  blind [-jN] [-lL] [-pPM_MAX] [-hMAX_HITS] [-sSNR_DB] [-nSLOTS]\n"
+    "                                  PDCCH blind decoding of test slots\n"
+    "  gpu [-bB] [-sSTREAMS]           GPU batch encoder, CUDA builds only\n"
+    "  serve [-jN] [-nSLOTS] [-mNAME] [-uPORT] [-tSECONDS] [-sSLOT_US]\n"
+    "                                  encoding service\n"
+    "or:    xt_ex <dir> [gemm | packed | batch | decode [L] | ofdm | convert]\n";
+
 int main(int argc, char *argv[]) {
 
     // CLI args
     for (int i = 1; i < argc; ++i)
-        std::cout << argv[i] << "\n";
-    fs::path paramsPath{argv[1]}; // Note! Testcase path as argv[1]!
+        XT_TRACE(TRACE_INFO, TRACE_ARGS, argv[i]);
 
-    // Read params
-    params_s params;
-    readParams(paramsPath, &params);
+    // Test vector runner: run [-jN] <dir | glob | manifest>...
+    if (argc > 1 && std::string(argv[1]) == "run") {
+        int nThreads = 0;
+        std::vector<std::string> args;
+        for (int i = 2; i < argc; ++i) {
+            std::string a(argv[i]);
+            if (a.rfind("-j", 0) == 0)
+                nThreads = std::atoi(a.c_str() + 2);
+            else
+                args.push_back(a);
+        }
+        runTvs(runFind(args), nThreads);
+        if (profOn())
+            profDump(std::cout); // Stage latencies with XT_PROF=1
+        return 0;
+    }
 
-    // Encoding
-    encDl(paramsPath, &params);
+    // BLER sweep: sim [-jN] [-lL] [-q] [-eFROM:TO:STEP] [-bBLOCKS] [-tERRORS]
+    // <dir | glob | manifest>..., CSV on stdout, -q for QPSK instead of BPSK
+    if (argc > 1 && std::string(argv[1]) == "sim") {
+        simCfg_s opt;
+        simDefaults(&opt);
+        std::vector<std::string> args;
+        for (int i = 2; i < argc; ++i) {
+            std::string a(argv[i]);
+            double from, to, step;
+            if (a.rfind("-j", 0) == 0)
+                opt.nThreads = std::atoi(a.c_str() + 2);
+            else if (a.rfind("-l", 0) == 0)
+                opt.L = std::atoi(a.c_str() + 2);
+            else if (a == "-q")
+                opt.mod = SIM_QPSK;
+            else if (a.rfind("-e", 0) == 0 &&
+                     std::sscanf(a.c_str() + 2, "%lf:%lf:%lf", &from, &to, &step) == 3) {
+                opt.ebN0Db.clear();
+                for (double e = from; e <= to + 1e-9; e += step)
+                    opt.ebN0Db.push_back(e);
+            } else if (a.rfind("-b", 0) == 0)
+                opt.maxBlocks = std::atoll(a.c_str() + 2);
+            else if (a.rfind("-t", 0) == 0)
+                opt.targetErrors = std::atoll(a.c_str() + 2);
+            else
+                args.push_back(a);
+        }
+        bool header = true;
+        for (const fs::path &dir : runFind(args)) {
+            simCfg_s cfg = opt;
+            readParams(dir, &cfg.params);
+            std::vector<simPoint_s> points;
+            simRun(&cfg, &points);
+            simCsv(std::cout, &cfg, points, header);
+            header = false;
+        }
+        return 0;
+    }
 
-    // ex1_run();
-    // ex2_run();
-    // ex3_run();
-    // ex4_run();
+    // Corpus load rate: load [-jN] <dir | glob | manifest>..., every text file of the
+    // test vectors mapped and parsed on the pool
+    if (argc > 1 && std::string(argv[1]) == "load") {
+        int nThreads = 0;
+        std::vector<std::string> args;
+        for (int i = 2; i < argc; ++i) {
+            std::string a(argv[i]);
+            if (a.rfind("-j", 0) == 0)
+                nThreads = std::atoi(a.c_str() + 2);
+            else
+                args.push_back(a);
+        }
+        tvlLoadAll(runFind(args), nThreads);
+        return 0;
+    }
 
-    // ex1_vec_run();
-    // ex2_vec_run();
-    // ex3_vec_run();
-    // ex4_vec_run();
+    // PDCCH blind decoding: blind [-jN] [-lL] [-pPM_MAX] [-hMAX_HITS] [-sSNR_DB]
+    // [-nSLOTS], test slots of the default search space with one DCI each
+    if (argc > 1 && std::string(argv[1]) == "blind") {
+        blindCfg_s cfg;
+        blindDefaults(&cfg);
+        double snrDb = 3;
+        int nSlots = 1000;
+        for (int i = 2; i < argc; ++i) {
+            std::string a(argv[i]);
+            if (a.rfind("-j", 0) == 0)
+                cfg.nThreads = std::atoi(a.c_str() + 2);
+            else if (a.rfind("-l", 0) == 0)
+                cfg.L = std::atoi(a.c_str() + 2);
+            else if (a.rfind("-p", 0) == 0)
+                cfg.pmMax = std::atof(a.c_str() + 2);
+            else if (a.rfind("-h", 0) == 0)
+                cfg.maxHits = std::atoi(a.c_str() + 2);
+            else if (a.rfind("-s", 0) == 0)
+                snrDb = std::atof(a.c_str() + 2);
+            else if (a.rfind("-n", 0) == 0)
+                nSlots = std::atoi(a.c_str() + 2);
+        }
+        blindRun(&cfg, snrDb, nSlots);
+        return 0;
+    }
 
-    // ex1_view_run();
-    ex2_ind_run();
-    ex3_ind_run();
-    // ex1_ind_run();
-    // ex1_rnd_run();
+#ifdef XT_EX_CUDA
+    // GPU batch encoder against the CPU one: gpu [-bB] [-sSTREAMS] <dir | glob |
+    // manifest>..., B random codewords per test vector configuration
+    if (argc > 1 && std::string(argv[1]) == "gpu") {
+        int B = 65536, nStreams = 2;
+        std::vector<std::string> args;
+        for (int i = 2; i < argc; ++i) {
+            std::string a(argv[i]);
+            if (a.rfind("-b", 0) == 0)
+                B = std::atoi(a.c_str() + 2);
+            else if (a.rfind("-s", 0) == 0)
+                nStreams = std::atoi(a.c_str() + 2);
+            else
+                args.push_back(a);
+        }
+        batchGpuRun(runFind(args), B, nStreams);
+        return 0;
+    }
+#endif
 
-    // ex1_csv_run();
+    // Encoding service: serve [-jN] [-nSLOTS] [-mNAME] [-uPORT] [-tSECONDS] [-sSLOT_US]
+    // [<dir | glob | manifest>...], rings in shared memory NAME.req / NAME.rsp with -m,
+    // test vectors as built-in load checked against their rm_bits
+    if (argc > 1 && std::string(argv[1]) == "serve") {
+        svcCfg_s cfg;
+        svcDefaults(&cfg);
+        double seconds = 0;
+        int slotUs = 500;
+        std::string shmName;
+        std::vector<std::string> args;
+        for (int i = 2; i < argc; ++i) {
+            std::string a(argv[i]);
+            if (a.rfind("-j", 0) == 0)
+                cfg.nThreads = std::atoi(a.c_str() + 2);
+            else if (a.rfind("-n", 0) == 0)
+                cfg.nSlots = std::atoi(a.c_str() + 2);
+            else if (a.rfind("-m", 0) == 0)
+                shmName = a.substr(2);
+            else if (a.rfind("-u", 0) == 0)
+                cfg.udpPort = std::atoi(a.c_str() + 2);
+            else if (a.rfind("-t", 0) == 0)
+                seconds = std::atof(a.c_str() + 2);
+            else if (a.rfind("-s", 0) == 0)
+                slotUs = std::atoi(a.c_str() + 2);
+            else
+                args.push_back(a);
+        }
+        if (!shmName.empty())
+            cfg.shmName = shmName.c_str();
+        svcServe(&cfg, runFind(args), seconds, slotUs);
+        return 0;
+    }
 
-    // ex1_qck_run();
-    // ex1_red_run();
-    // ex1_man_run();
+    if (argc < 2 || argv[1][0] == '-') {
+        std::cerr << mainUsage;
+        return 1;
+    }
+    fs::path paramsPath{argv[1]}; // Note! Testcase path as argv[1]!
+    encMode_e encMode = ENC_BUTTERFLY;
+    if (argc > 2 && std::string(argv[2]) == "gemm")
+        encMode = ENC_GEMM; // Note! Generator matrix reference as argv[2]!
+    if (argc > 2 && std::string(argv[2]) == "packed")
+        encMode = ENC_PACKED;
+    if (argc > 2 && std::string(argv[2]) == "batch")
+        encMode = ENC_BATCH;
+    bool decode = argc > 2 && std::string(argv[2]) == "decode"; // List size as argv[3]
+    bool ofdm = argc > 2 && std::string(argv[2]) == "ofdm"; // QPSK + OFDM after encoding
+    if (argc > 2 && std::string(argv[2]) == "convert") {
+        tvConvert(paramsPath); // One-shot text to binary test vector conversion
+        return 0;
+    }
 
-    // ex1_crc_run();
-    // ex2_crc_run();
-    // ex1_mpow_run();
+    // Read params
+    polarCfg_s cfg;
+    polarCfgRead(paramsPath, &cfg);
 
-    // ex1_cmplx_run();
-    // ex2_cmplx_run();
+    // Encoding, or decoding of the rate matched bits
+    if (decode)
+        decDl(paramsPath, &cfg, argc > 3 ? std::atoi(argv[3]) : DEC_L_MAX);
+    else if (ofdm)
+        ofdmDl(paramsPath, &cfg);
+    else
+        encDl(paramsPath, &cfg, encMode);
+    if (profOn())
+        profDump(std::cout);
 
     return 0;
 }
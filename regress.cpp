@@ -0,0 +1,493 @@
+#include "bitvec.h"
+#include "crc.h"
+#include "pattern.h"
+#include "plan.h"
+#include "polar.h"
+#include "polarcfg.h"
+#include "ratematch.h"
+#include "runner.h"
+#include "util.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <xtensor-blas/xlinalg.hpp>
+#include <xtensor/xadapt.hpp>
+#include <xtensor/xarray.hpp>
+#include <xtensor/xbuilder.hpp>
+#include <xtensor/xindex_view.hpp>
+#include <xtensor/xmanipulation.hpp>
+#include <xtensor/xoperation.hpp>
+
+namespace fs = std::filesystem;
+
+// Regression harness
+//
+// The GEMM reference chain of encdl.cpp and the packed engines side by side, stage by
+// stage, on every test vector directory and on random downlink configurations:
+//
+//   crc    dot with crc_gen_m          crcAttach
+//   enc    scrambling, interleaving,   planFrozenInsert + polarEncPacked
+//          frozen bits, enc_gen_m dot
+//   rm     index_view of the pattern   rmStreamPacked
+//   chain  all of the above            planEncode
+//
+// Both paths must agree bit for bit, and with crc_bits, enc_bits and rm_bits of a test
+// vector. Test vectors use their own matrices and patterns, which must equal the ones
+// generated here from the 38.212 definitions (stage gen); random configurations use the
+// generated ones.
+//
+// Each stage is timed as the median over samples of back to back calls. Results go to a
+// JSON file, one record per line. Given the file of an earlier commit with -b, every
+// fast path slower than the baseline by more than -t percent is reported. Exit status 1
+// on a mismatch or a regression.
+//
+// Usage: xt_regress [-oOUT] [-bBASELINE] [-tPCT] [-rRANDOM] [-sSEED] [-nSAMPLES]
+//                   [dir | glob | manifest]...   (default dl)
+
+// Inputs and stage outputs of the reference chain, one value per bit
+typedef struct regressRef_s {
+    xt::xarray<int> info; // A
+    xt::xarray<int> rnti; // 16, MSB first
+    xt::xarray<int> crcGenMtx; // K x P
+    xt::xarray<int> encGenMtx; // N x N
+    xt::xarray<int> crcIntrl;  // K
+    xt::xarray<int> infoIntrl; // N, 1 on info bit positions
+    xt::xarray<int> rmPat;     // E
+    xt::xarray<int> crc;       // P
+    xt::xarray<int> enc;       // N
+    xt::xarray<int> rm;        // E
+} regressRef_s;
+
+// One stage of one configuration
+typedef struct regressRec_s {
+    std::string name; // Directory, or A/E of a random configuration
+    params_s params;
+    std::string stage;
+    int nDiff;     // Bits differing between the paths or from the file
+    double refNs;  // 0 when not timed
+    double fastNs;
+} regressRec_s;
+
+// Keep the compiler from dropping calls whose results are only overwritten
+static inline void regressClobber() {
+#if defined(__GNUC__)
+    asm volatile("" ::: "memory");
+#endif
+}
+
+// Median ns per call over nSamples samples, each of enough calls to last ~20 us
+template <class F> static double regressTime(int nSamples, F &&fn) {
+    using clock = std::chrono::steady_clock;
+    auto ns = [](clock::time_point t0) {
+        return double(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          clock::now() - t0)
+                          .count());
+    };
+
+    // Calls per sample, doubled until a sample is long enough
+    int nCalls = 1;
+    for (;; nCalls *= 2) {
+        clock::time_point t0 = clock::now();
+        for (int i = 0; i < nCalls; ++i) {
+            fn();
+            regressClobber();
+        }
+        if (ns(t0) >= 20000 || nCalls >= (1 << 20))
+            break;
+    }
+
+    // Median of the samples
+    std::vector<double> t(nSamples);
+    for (double &s : t) {
+        clock::time_point t0 = clock::now();
+        for (int i = 0; i < nCalls; ++i) {
+            fn();
+            regressClobber();
+        }
+        s = ns(t0) / nCalls;
+    }
+    std::nth_element(t.begin(), t.begin() + nSamples / 2, t.end());
+    return t[nSamples / 2];
+}
+
+// Generated references
+
+// crc_gen_m.txt layout, P x K: column k is the CRC of input bit k of P ones and A info
+// bits, D^(K - 1 - k + P) mod g(D) with p_0 the coefficient of D^(P - 1). Long division
+// on the polynomial, independent of the CRC tables.
+static std::vector<int> regressCrcGen(const params_s *p) {
+    const crcTable_s *tab = crcSelect(p->P);
+    std::vector<int> gen(size_t(p->P) * p->K);
+    for (int k = 0; k < p->K; ++k) {
+        uint64_t r = crcPolyMod(p->K - 1 - k + p->P, p->P, tab->poly);
+        for (int i = 0; i < p->P; ++i)
+            gen[size_t(i) * p->K + k] = (r >> (p->P - 1 - i)) & 1;
+    }
+    return gen;
+}
+
+// enc_gen_m.txt layout, the transpose of F^{(x)n}: row j, column i is 1 when the bits
+// of j are a subset of those of i
+static std::vector<int> regressEncGen(int N) {
+    std::vector<int> gen(size_t(N) * N);
+    for (int j = 0; j < N; ++j)
+        for (int i = 0; i < N; ++i)
+            gen[size_t(j) * N + i] = (i & j) == j;
+    return gen;
+}
+
+// Matrices of the reference chain from the file layouts, as encDl reads them
+static void regressMatrices(regressRef_s *r, const params_s *p, xt::xarray<int> crcGen,
+                            xt::xarray<int> encGen) {
+    r->crcGenMtx = xt::transpose(crcGen.reshape({p->P, p->K}));
+    r->encGenMtx = xt::transpose(encGen.reshape({p->N, p->N}));
+}
+
+static int regressDiff(const xt::xarray<int> &a, const xt::xarray<int> &b) {
+    if (a.size() != b.size())
+        return int(std::max(a.size(), b.size()));
+    int n = 0;
+    for (size_t i = 0; i < a.size(); ++i)
+        n += a.data()[i] != b.data()[i];
+    return n;
+}
+
+// Packed bits against one value per bit
+static int regressDiff(const uint64_t *words, const xt::xarray<int> &bits) {
+    int n = 0;
+    for (size_t i = 0; i < bits.size(); ++i)
+        n += int((words[i >> 6] >> (i & 63)) & 1) != bits.data()[i];
+    return n;
+}
+
+// Reference stages
+
+static void regressRefCrc(regressRef_s *r, const params_s *p) {
+    r->crc = xt::linalg::dot(xt::concatenate(xt::xtuple(xt::ones<int>({p->P}), r->info)),
+                             r->crcGenMtx);
+    r->crc %= 2;
+}
+
+static void regressRefEnc(regressRef_s *r, const params_s *p) {
+    xt::xarray<int> scrBits =
+        r->crc ^ xt::concatenate(
+                     xt::xtuple(xt::zeros<int>({p->P - r->rnti.size()}), r->rnti));
+    xt::xarray<int> infoCrcBits = xt::concatenate(xt::xtuple(r->info, scrBits));
+    xt::xarray<int> intrlBits = xt::index_view(infoCrcBits, r->crcIntrl);
+    xt::xarray<int> frozenBits = xt::zeros<int>({p->N});
+    xt::filter(frozenBits, r->infoIntrl > 0) = intrlBits;
+    r->enc = xt::linalg::dot(frozenBits, r->encGenMtx);
+    r->enc %= 2;
+}
+
+static void regressRefRm(regressRef_s *r) { r->rm = xt::index_view(r->enc, r->rmPat); }
+
+// Both paths on one configuration
+
+static int regressCase(const std::string &name, const polarCfg_s *cfg, regressRef_s *r,
+                       const fs::path *dir, int nSamples,
+                       std::vector<regressRec_s> *recs) {
+    const params_s *p = &cfg->params;
+    std::shared_ptr<const plan_s> plan = planGet(planCacheDefault(), cfg);
+    auto rec = [&](const char *stage, int nDiff, double refNs, double fastNs) {
+        recs->push_back({name, *p, stage, nDiff, refNs, fastNs});
+        return nDiff;
+    };
+
+    // Packed inputs of the fast path
+    bitvec_s info, crc, u, enc, rm;
+    bvPack(&info, r->info.data(), p->A);
+    uint16_t rnti = 0;
+    for (int b : r->rnti)
+        rnti = (rnti << 1) | b;
+    bvInit(&u, p->N);
+    bvInit(&enc, p->N);
+    bvInit(&rm, p->E);
+
+    // Outputs once, then the timings
+    regressRefCrc(r, p);
+    regressRefEnc(r, p);
+    regressRefRm(r);
+    crcAttach(plan->crc, &info, &crc);
+    planFrozenInsert(plan.get(), info.words.data(), rnti, u.words.data());
+    enc.words = u.words;
+    polarEncPacked(enc.words.data(), p->N);
+    rmStreamPacked(&plan->rmStream, enc.words.data(), rm.words.data());
+    bitvec_s chain;
+    bvInit(&chain, p->E);
+    planEncode(plan.get(), info.words.data(), rnti, chain.words.data());
+
+    int nDiffCrc = regressDiff(crc.words.data(), r->crc);
+    int nDiffEnc = regressDiff(enc.words.data(), r->enc);
+    int nDiffRm = regressDiff(rm.words.data(), r->rm);
+    int nDiffChain = regressDiff(chain.words.data(), r->rm);
+    if (dir) {
+        nDiffCrc += regressDiff(r->crc, readBits(*dir / "crc_bits.txt"));
+        nDiffEnc += regressDiff(r->enc, readBits(*dir / "enc_bits.txt"));
+        xt::xarray<int> rmRef = readBits(*dir / "rm_bits.txt");
+        nDiffRm += regressDiff(r->rm, rmRef);
+        nDiffChain += regressDiff(chain.words.data(), rmRef);
+    }
+
+    double crcRef = regressTime(nSamples, [&] { regressRefCrc(r, p); });
+    double crcFast = regressTime(nSamples, [&] { crcAttach(plan->crc, &info, &crc); });
+    double encRef = regressTime(nSamples, [&] { regressRefEnc(r, p); });
+    double encFast = regressTime(nSamples, [&] {
+        planFrozenInsert(plan.get(), info.words.data(), rnti, enc.words.data());
+        polarEncPacked(enc.words.data(), p->N);
+    });
+    double rmRef = regressTime(nSamples, [&] { regressRefRm(r); });
+    double rmFast = regressTime(nSamples, [&] {
+        rmStreamPacked(&plan->rmStream, enc.words.data(), rm.words.data());
+    });
+    double chainRef = regressTime(nSamples, [&] {
+        regressRefCrc(r, p);
+        regressRefEnc(r, p);
+        regressRefRm(r);
+    });
+    double chainFast = regressTime(nSamples, [&] {
+        planEncode(plan.get(), info.words.data(), rnti, chain.words.data());
+    });
+
+    return rec("crc", nDiffCrc, crcRef, crcFast) + rec("enc", nDiffEnc, encRef, encFast) +
+           rec("rm", nDiffRm, rmRef, rmFast) +
+           rec("chain", nDiffChain, chainRef, chainFast);
+}
+
+// Test vector directory: its own matrices and patterns, checked against the generated
+static int regressTv(const fs::path &dir, int nSamples, std::vector<regressRec_s> *recs) {
+    polarCfg_s cfg;
+    polarCfgRead(dir, &cfg);
+    const params_s *p = &cfg.params;
+    if (p->link != LINK_DL)
+        return 0; // No matrices for the uplink chain
+
+    regressRef_s r;
+    r.info = readBits(dir / "info_bits.txt");
+    r.rnti = readBits(dir / "rnti_bits.txt");
+    xt::xarray<int> crcGen = readBits(dir / "crc_gen_m.txt");
+    xt::xarray<int> encGen = readBits(dir / "enc_gen_m.txt");
+    r.crcIntrl = readBits(dir / "crc_interleaver_pattern.txt");
+    r.infoIntrl = readBits(dir / "info_bit_pattern.txt");
+    r.rmPat = readBits(dir / "rate_matching_pattern.txt");
+
+    std::vector<uint16_t> crcIntrl(p->K), rmPat(p->E);
+    std::vector<uint8_t> infoIntrl(p->N);
+    patCrcIntrl(p->K, crcIntrl.data());
+    patInfoBits(p->K, p->E, p->N, infoIntrl.data());
+    patRateMatch(p->K, p->E, p->N, rmPat.data());
+    std::vector<int> crcGenRef = regressCrcGen(p), encGenRef = regressEncGen(p->N);
+    int nDiffGen = regressDiff(crcGen, xt::adapt(crcGenRef)) +
+                   regressDiff(encGen, xt::adapt(encGenRef)) +
+                   regressDiff(r.crcIntrl, xt::adapt(crcIntrl)) +
+                   regressDiff(r.infoIntrl, xt::adapt(infoIntrl)) +
+                   regressDiff(r.rmPat, xt::adapt(rmPat));
+    recs->push_back({dir.string(), *p, "gen", nDiffGen, 0, 0});
+
+    regressMatrices(&r, p, crcGen, encGen);
+    return nDiffGen + regressCase(dir.string(), &cfg, &r, &dir, nSamples, recs);
+}
+
+// Random configuration and input, generated matrices and patterns
+static int regressRandom(int i, std::mt19937_64 *rng, int nSamples,
+                         std::vector<regressRec_s> *recs) {
+    // Draw until valid, E from K to 8 K
+    polarCfg_s cfg;
+    for (;;) {
+        int A = 1 + int((*rng)() % (PAT_K_IL_MAX - 24));
+        int E = (A + 24) * (8 + int((*rng)() % 57)) / 8;
+        try {
+            polarCfgMake(&cfg, A, E, LINK_DL);
+            break;
+        } catch (const std::runtime_error &) {
+        }
+    }
+    const params_s *p = &cfg.params;
+
+    regressRef_s r;
+    r.info = xt::zeros<int>({p->A});
+    for (int b = 0; b < p->A; ++b)
+        r.info(b) = (*rng)() & 1;
+    uint16_t rnti = uint16_t((*rng)());
+    r.rnti = xt::zeros<int>({16});
+    for (int b = 0; b < 16; ++b)
+        r.rnti(b) = (rnti >> (15 - b)) & 1;
+
+    std::vector<uint16_t> crcIntrl(p->K), rmPat(p->E);
+    std::vector<uint8_t> infoIntrl(p->N);
+    patCrcIntrl(p->K, crcIntrl.data());
+    patInfoBits(p->K, p->E, p->N, infoIntrl.data());
+    patRateMatch(p->K, p->E, p->N, rmPat.data());
+    r.crcIntrl = xt::adapt(crcIntrl);
+    r.infoIntrl = xt::adapt(infoIntrl);
+    r.rmPat = xt::adapt(rmPat);
+    std::vector<int> crcGen = regressCrcGen(p), encGen = regressEncGen(p->N);
+    regressMatrices(&r, p, xt::adapt(crcGen), xt::adapt(encGen));
+
+    std::string name = "random" + std::to_string(i) + "/" + std::to_string(p->A) + "/" +
+                       std::to_string(p->E);
+    return regressCase(name, &cfg, &r, nullptr, nSamples, recs);
+}
+
+// Results file
+
+// JSON string body of s, quotes, backslashes and control characters escaped
+static std::string regressQuote(const std::string &s) {
+    std::string q;
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            q += '\\';
+            q += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char hex[8];
+            std::snprintf(hex, sizeof(hex), "\\u%04x", c);
+            q += hex;
+        } else {
+            q += c;
+        }
+    }
+    return q;
+}
+
+static void regressWrite(const fs::path &path, const std::vector<regressRec_s> &recs) {
+    std::ofstream os(path);
+    if (!os)
+        throw std::runtime_error(path.string() + ": cannot write");
+    os << std::fixed << std::setprecision(1) << "{\n  \"results\": [\n";
+    for (size_t i = 0; i < recs.size(); ++i) {
+        const regressRec_s *q = &recs[i];
+        os << "    {\"name\": \"" << regressQuote(q->name) << "\", \"stage\": \""
+           << regressQuote(q->stage)
+           << "\", \"A\": " << q->params.A << ", \"K\": " << q->params.K
+           << ", \"E\": " << q->params.E << ", \"N\": " << q->params.N
+           << ", \"nDiff\": " << q->nDiff << ", \"refNs\": " << q->refNs
+           << ", \"fastNs\": " << q->fastNs << "}" << (i + 1 < recs.size() ? "," : "")
+           << "\n";
+    }
+    os << "  ]\n}\n";
+}
+
+// JSON string starting at the quote at line[*i], unescaped; *i moves past it
+static std::string regressString(const std::string &line, size_t *i) {
+    std::string str;
+    size_t e = *i + 1;
+    for (; e < line.size() && line[e] != '"'; ++e) {
+        if (line[e] == '\\' && e + 1 < line.size() && line[++e] == 'u') {
+            str += char(std::strtol(line.substr(e + 1, 4).c_str(), nullptr, 16));
+            e += 4;
+        } else {
+            str += line[e];
+        }
+    }
+    *i = e + 1;
+    return str;
+}
+
+// Key / value pairs of one record line, numbers as text
+static std::map<std::string, std::string> regressFields(const std::string &line) {
+    std::map<std::string, std::string> fields;
+    for (size_t i = line.find('"'); i < line.size(); i = line.find('"', i)) {
+        std::string key = regressString(line, &i);
+        if (line.compare(i, 2, ": ") != 0)
+            continue;
+        i += 2;
+        if (i < line.size() && line[i] == '"') {
+            fields[key] = regressString(line, &i);
+        } else {
+            size_t e = std::min(line.find_first_of(",}", i), line.size());
+            fields[key] = line.substr(i, e - i);
+            i = e;
+        }
+    }
+    return fields;
+}
+
+// Fast path timings of a file written by regressWrite, by name and stage
+static std::map<std::string, double> regressRead(const fs::path &path) {
+    std::ifstream is(path);
+    if (!is)
+        throw std::runtime_error(path.string() + ": cannot read");
+    std::map<std::string, double> ns;
+    for (std::string line; std::getline(is, line);) {
+        std::map<std::string, std::string> f = regressFields(line);
+        if (f.count("fastNs"))
+            ns[f["name"] + " " + f["stage"]] = std::atof(f["fastNs"].c_str());
+    }
+    return ns;
+}
+
+int main(int argc, char *argv[]) {
+    fs::path out = "regress.json", base;
+    double pct = 25;
+    int nRandom = 16, nSamples = 15;
+    uint64_t seed = 1;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i) {
+        std::string a(argv[i]);
+        if (a.rfind("-o", 0) == 0)
+            out = a.substr(2);
+        else if (a.rfind("-b", 0) == 0)
+            base = a.substr(2);
+        else if (a.rfind("-t", 0) == 0)
+            pct = std::atof(a.c_str() + 2);
+        else if (a.rfind("-r", 0) == 0)
+            nRandom = std::atoi(a.c_str() + 2);
+        else if (a.rfind("-s", 0) == 0)
+            seed = std::strtoull(a.c_str() + 2, nullptr, 0);
+        else if (a.rfind("-n", 0) == 0)
+            nSamples = std::max(1, std::atoi(a.c_str() + 2));
+        else
+            args.push_back(a);
+    }
+    if (args.empty())
+        args.push_back("dl");
+
+    // Test vectors, then the random configurations
+    std::vector<regressRec_s> recs;
+    int nDiff = 0;
+    for (const fs::path &dir : runFind(args))
+        nDiff += regressTv(dir, nSamples, &recs);
+    std::mt19937_64 rng(seed);
+    for (int i = 0; i < nRandom; ++i)
+        nDiff += regressRandom(i, &rng, nSamples, &recs);
+
+    // Table, results file and the comparison with the baseline
+    std::map<std::string, double> baseNs;
+    if (!base.empty())
+        baseNs = regressRead(base);
+    int nSlower = 0;
+    std::printf("%-24s %-6s %6s %12s %12s %8s %8s\n", "name", "stage", "nDiff", "ref ns",
+                "fast ns", "speedup", "vs base");
+    for (const regressRec_s &q : recs) {
+        std::printf("%-24s %-6s %6d %12.1f %12.1f", q.name.c_str(), q.stage.c_str(),
+                    q.nDiff, q.refNs, q.fastNs);
+        if (q.fastNs > 0)
+            std::printf(" %7.1fx", q.refNs / q.fastNs);
+        auto b = baseNs.find(q.name + " " + q.stage);
+        if (q.fastNs > 0 && b != baseNs.end() && b->second > 0) {
+            double ratio = q.fastNs / b->second;
+            bool slower = ratio > 1 + pct / 100;
+            nSlower += slower;
+            std::printf(" %7.2fx%s", ratio, slower ? " SLOWER" : "");
+        }
+        std::printf("\n");
+    }
+    regressWrite(out, recs);
+    std::cout << "nDiffBits: " << nDiff << std::endl;
+    if (!base.empty())
+        std::cout << "nSlower: " << nSlower << " (over " << pct << " % against "
+                  << base.string() << ")" << std::endl;
+    return nDiff || nSlower ? 1 : 0;
+}
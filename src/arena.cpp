@@ -0,0 +1,71 @@
+#include "arena.h"
+#include "encdl.h"
+#include "plan.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+arena_s *arenaThread() {
+    thread_local arena_s arena = {{}, 0, 0};
+    return &arena;
+}
+
+size_t arenaBytes(const params_s *params) {
+    // xarray chain: int per bit for the info + CRC, interleaved, u/x and rate matched
+    // arrays, plus the bit-sliced batch output and alignment slack
+    size_t nInts = 3 * size_t(params->K) + 2 * size_t(params->P) + 2 * size_t(params->N) +
+                   2 * size_t(params->E);
+    size_t nSlices = size_t(params->E) + PLAN_N_MAX;
+    return nInts * sizeof(int) + nSlices * sizeof(uint64_t) + 16 * 64;
+}
+
+void arenaReserve(arena_s *arena, size_t nBytes) {
+    if (arena->used)
+        throw std::runtime_error("arena reserved with spans outstanding");
+    size_t nUnits = (nBytes + 7) / 8 + 8; // Room to align the base
+    if (arena->buf.size() < nUnits)
+        arena->buf.resize(nUnits);
+}
+
+void *arenaAlloc(arena_s *arena, size_t nBytes) {
+    if (arena->used == 0 && nBytes + 64 > arena->buf.size() * 8)
+        arenaReserve(arena, nBytes + 64);
+    uintptr_t base = reinterpret_cast<uintptr_t>(arena->buf.data());
+    uintptr_t aligned = (base + 63) & ~uintptr_t{63};
+    size_t off = (arena->used + 63) & ~size_t{63};
+    if (aligned - base + off + nBytes > arena->buf.size() * 8)
+        throw std::runtime_error("arena reservation exceeded");
+    arena->used = off + nBytes;
+    if (arena->used > arena->peak)
+        arena->peak = arena->used;
+    return reinterpret_cast<void *>(aligned + off);
+}
+
+#ifdef XT_EX_COUNT_ALLOC
+
+static std::atomic<int64_t> nAllocs{0};
+
+int64_t allocCount() { return nAllocs.load(std::memory_order_relaxed); }
+
+void *operator new(size_t n) {
+    nAllocs.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t n) { return operator new(n); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+void operator delete[](void *p, size_t) noexcept { std::free(p); }
+
+#else
+
+int64_t allocCount() { return -1; }
+
+#endif
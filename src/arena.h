@@ -0,0 +1,53 @@
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include "encdl.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <xtensor/xadapt.hpp>
+
+// Per-thread bump arena for pipeline scratch. The buffer is sized once from params_s
+// with arenaReserve, stages then take spans with arenaAlloc and give them back with
+// arenaRelease, so steady state encoding does not touch the heap.
+typedef struct arena_s {
+    std::vector<uint64_t> buf; // 8-byte units, spans are 64-byte aligned
+    size_t used;               // Bytes in use
+    size_t peak;
+} arena_s;
+
+// Arena of the calling thread
+arena_s *arenaThread();
+
+// Scratch bytes for one codeword of params, all stages
+size_t arenaBytes(const params_s *params);
+
+// Grow the arena to hold nBytes. Must not be called with spans outstanding.
+void arenaReserve(arena_s *arena, size_t nBytes);
+
+// Span of nBytes. An empty arena grows on demand, otherwise exceeding the reservation
+// throws since outstanding spans cannot move.
+void *arenaAlloc(arena_s *arena, size_t nBytes);
+
+inline size_t arenaMark(const arena_s *arena) { return arena->used; }
+inline void arenaRelease(arena_s *arena, size_t mark) { arena->used = mark; }
+
+template <class T> inline T *arenaArray(arena_s *arena, size_t n) {
+    return static_cast<T *>(arenaAlloc(arena, n * sizeof(T)));
+}
+
+// 1-D tensor view of a span, zeroed unless the caller writes all of it. Fixed rank
+// so no shape allocation either.
+template <class T> inline auto arenaAdapt(arena_s *arena, size_t n, bool zero = true) {
+    T *p = arenaArray<T>(arena, n);
+    if (zero)
+        std::fill(p, p + n, T(0));
+    return xt::adapt(p, n, xt::no_ownership(), std::array<size_t, 1>{n});
+}
+
+// Global operator new calls so far, -1 when built without XT_EX_COUNT_ALLOC
+int64_t allocCount();
+
+#endif // ARENA_H_
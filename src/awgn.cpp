@@ -0,0 +1,43 @@
+#include "awgn.h"
+#include "simd.h"
+#include <algorithm>
+#include <complex>
+#include <cstdint>
+
+void awgnInit(awgn_s *awgn, uint64_t seed, uint64_t stream) {
+    awgn->key[0] = uint32_t(seed);
+    awgn->key[1] = uint32_t(seed >> 32);
+    awgn->stream = stream;
+    awgn->ctr = 0;
+}
+
+void awgnReal(awgn_s *awgn, float *out, int n, float sigma) {
+    const simdKernels_s *simd = simdGet();
+
+    // Whole blocks straight into out, the partial last one through a copy
+    int nBlocks = n / 4;
+    simd->gauss(awgn->key, awgn->stream, awgn->ctr, nBlocks, sigma, out);
+    awgn->ctr += nBlocks;
+    if (int tail = n % 4) {
+        float blk[4];
+        simd->gauss(awgn->key, awgn->stream, awgn->ctr++, 1, sigma, blk);
+        std::copy(blk, blk + tail, out + n - tail);
+    }
+}
+
+void awgnCplx(awgn_s *awgn, std::complex<float> *out, int n, float sigma) {
+    // complex<float> is an array of re, im
+    awgnReal(awgn, reinterpret_cast<float *>(out), 2 * n, sigma);
+}
+
+void awgnAdd(awgn_s *awgn, const std::complex<float> *in, std::complex<float> *out,
+             int n, float sigma) {
+    const int chunk = 256;
+    std::complex<float> noise[chunk];
+    for (int i = 0; i < n; i += chunk) {
+        int m = std::min(chunk, n - i);
+        awgnCplx(awgn, noise, m, sigma);
+        for (int j = 0; j < m; ++j)
+            out[i + j] = in[i + j] + noise[j];
+    }
+}
@@ -0,0 +1,32 @@
+#ifndef AWGN_H_
+#define AWGN_H_
+
+#include <complex>
+#include <cstdint>
+
+// Gaussian noise for link level simulations. Block i of stream s under a seed is a
+// pure function of (seed, s, i) (Philox4x32-10), so streams share no state: one per
+// thread or per work item, and results do not depend on scheduling. A block is 4
+// floats, 2 complex samples, generated by the SIMD kernels of simd.h.
+typedef struct awgn_s {
+    uint32_t key[2]; // Seed
+    uint64_t stream;
+    uint64_t ctr; // Next block
+} awgn_s;
+
+void awgnInit(awgn_s *awgn, uint64_t seed, uint64_t stream);
+
+// Jump to block ctr of the stream
+inline void awgnSeek(awgn_s *awgn, uint64_t ctr) { awgn->ctr = ctr; }
+
+// n N(0, sigma^2) floats. The stream advances by whole blocks, ceil(n / 4).
+void awgnReal(awgn_s *awgn, float *out, int n, float sigma);
+
+// n complex samples with N(0, sigma^2) real and imaginary parts, N0 = 2 sigma^2
+void awgnCplx(awgn_s *awgn, std::complex<float> *out, int n, float sigma);
+
+// out = in + noise, in place when out == in
+void awgnAdd(awgn_s *awgn, const std::complex<float> *in, std::complex<float> *out,
+             int n, float sigma);
+
+#endif // AWGN_H_
@@ -0,0 +1,99 @@
+#include "batch.h"
+#include "arena.h"
+#include "bitvec.h"
+#include "plan.h"
+#include "simd.h"
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+void batchEncodeSliced(const plan_s *plan, const uint64_t *info, const uint64_t *rnti,
+                       uint64_t *rm) {
+    const params_s *p = &plan->params;
+    const crcTable_s *crc = plan->crc;
+    uint64_t c[PLAN_K_MAX] = {};
+    uint64_t u[PLAN_N_MAX] = {};
+
+    // CRC shift register, r[j] is the coefficient of D^j, initialized to the state
+    // after the P leading ones (reflected register bit i is r[P - 1 - i])
+    uint64_t r[32];
+    uint64_t taps[32];
+    for (int j = 0; j < crc->L; ++j) {
+        r[j] = ((crc->onesInit >> (crc->L - 1 - j)) & 1) ? ~uint64_t{0} : 0;
+        taps[j] = ((crc->poly >> j) & 1) ? ~uint64_t{0} : 0;
+    }
+
+    // CRC computation, one codeword per lane
+    for (int i = 0; i < p->A; ++i) {
+        uint64_t fb = r[crc->L - 1] ^ info[i];
+        for (int j = crc->L - 1; j > 0; --j)
+            r[j] = r[j - 1] ^ (fb & taps[j]);
+        r[0] = fb;
+        c[i] = info[i];
+    }
+
+    // CRC scrambling and attachment, CRC bit k is r[P - 1 - k]
+    for (int k = 0; k < p->P; ++k)
+        c[p->A + k] = r[p->P - 1 - k];
+    if (p->P >= 16)
+        for (int j = 0; j < 16; ++j)
+            c[p->A + p->P - 16 + j] ^= rnti[j];
+
+    // CRC interleaver and frozen bit insertion as word moves
+    for (int k = 0; k < p->K; ++k)
+        u[plan->infoPos[k]] = c[plan->crcIntrl[k]];
+
+    // Encoding, butterfly on whole words
+    simdGet()->polarWords(u, p->N);
+
+    // Rate matching
+    for (int e = 0; e < p->E; ++e)
+        rm[e] = u[plan->rmIdx[e]];
+}
+
+void batchEncode(const plan_s *plan, int B, const uint64_t *info, const uint16_t *rnti,
+                 uint64_t *rm) {
+    const params_s *p = &plan->params;
+    if (p->link != LINK_DL)
+        throw std::runtime_error("bit-sliced batch encodes downlink plans only");
+    int nInfoWords = bvWords(p->A);
+    int nRmWords = bvWords(p->E);
+    uint64_t sInfo[PLAN_K_MAX];
+    uint64_t sRnti[16];
+    uint64_t sRm[BATCH_LANES];
+    uint64_t t[BATCH_LANES];
+    arena_s *arena = arenaThread();
+    size_t mark = arenaMark(arena);
+    uint64_t *sOut = arenaArray<uint64_t>(arena, p->E);
+
+    for (int b0 = 0; b0 < B; b0 += BATCH_LANES) {
+        int nb = B - b0 < BATCH_LANES ? B - b0 : BATCH_LANES;
+
+        // Transpose info bits into slices, 64 bits at a time
+        for (int w = 0; w < nInfoWords; ++w) {
+            for (int b = 0; b < BATCH_LANES; ++b)
+                t[b] = b < nb ? info[(b0 + b) * nInfoWords + w] : 0;
+            bvTranspose64(t);
+            for (int j = 0; j < 64 && 64 * w + j < p->A; ++j)
+                sInfo[64 * w + j] = t[j];
+        }
+
+        // RNTI slices, MSB first
+        for (int j = 0; j < 16; ++j) {
+            sRnti[j] = 0;
+            for (int b = 0; b < nb; ++b)
+                sRnti[j] |= uint64_t((rnti[b0 + b] >> (15 - j)) & 1) << b;
+        }
+
+        // Encode the group, then transpose output slices back 64 at a time
+        batchEncodeSliced(plan, sInfo, sRnti, sOut);
+        for (int w = 0; w < nRmWords; ++w) {
+            for (int j = 0; j < 64; ++j)
+                sRm[j] = 64 * w + j < p->E ? sOut[64 * w + j] : 0;
+            bvTranspose64(sRm);
+            for (int b = 0; b < nb; ++b)
+                rm[(b0 + b) * nRmWords + w] = sRm[b];
+        }
+    }
+    arenaRelease(arena, mark);
+}
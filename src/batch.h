@@ -0,0 +1,21 @@
+#ifndef BATCH_H_
+#define BATCH_H_
+
+#include "plan.h"
+#include <cstdint>
+
+// Codewords per bit-sliced group, one per bit of a uint64 lane
+#define BATCH_LANES 64
+
+// Encode 64 codewords of the same plan in bit-sliced layout: word i holds bit i of
+// all 64 codewords (codeword b in bit b). info has A words, rnti 16 words (RNTI bit
+// j, MSB first, in word j) and rm receives E words.
+void batchEncodeSliced(const plan_s *plan, const uint64_t *info, const uint64_t *rnti,
+                       uint64_t *rm);
+
+// Encode B codewords of the same plan. info holds B rows of bvWords(A) packed words,
+// rnti B values and rm receives B rows of bvWords(E) packed words.
+void batchEncode(const plan_s *plan, int B, const uint64_t *info, const uint16_t *rnti,
+                 uint64_t *rm);
+
+#endif // BATCH_H_
@@ -0,0 +1,194 @@
+#include "batchgpu.h"
+#include "batch.h"
+#include "bitvec.h"
+#include "plan.h"
+#include "polarcfg.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cuda_runtime.h>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static_assert(PLAN_N_MAX <= 32 * 32, "one warp of 32-bit lanes holds a codeword");
+
+static void batchGpuCheck(cudaError_t err, const char *what) {
+    if (err != cudaSuccess)
+        throw std::runtime_error(std::string(what) + ": " + cudaGetErrorString(err));
+}
+
+// Device copy of n values, freed again when the copy fails
+template <class T> static T *batchGpuUpload(const T *src, size_t n) {
+    T *dst = nullptr;
+    batchGpuCheck(cudaMalloc(&dst, sizeof(T) * n), "cudaMalloc");
+    cudaError_t err = cudaMemcpy(dst, src, sizeof(T) * n, cudaMemcpyHostToDevice);
+    if (err != cudaSuccess)
+        cudaFree(dst);
+    batchGpuCheck(err, "cudaMemcpy");
+    return dst;
+}
+
+bool batchGpuAvailable() {
+    int n = 0;
+    return cudaGetDeviceCount(&n) == cudaSuccess && n > 0;
+}
+
+// Device tables and buffers, pinned host rows and streams of batchGpuCreate. Throws
+// part way on CUDA errors, with what was allocated so far in gpu.
+static void batchGpuAlloc(batchGpu_s *gpu, std::shared_ptr<const plan_s> plan, int maxB,
+                          int chunk, int nStreams) {
+    const params_s *p = &plan->params;
+
+    // Plan tables on the device
+    batchGpuCode_s *c = &gpu->code;
+    c->A = p->A;
+    c->P = p->P;
+    c->K = p->K;
+    c->N = p->N;
+    c->E = p->E;
+    c->nInfoWords = bvWords(p->A);
+    c->nCWords = bvWords(p->K + 1);
+    c->nRmWords = bvWords(p->E);
+    c->onesInit = plan->crc->onesInit;
+    c->polyRef = plan->crc->polyRef;
+    c->crcTab = batchGpuUpload(plan->crc->t[0], 256);
+    c->uSrc = batchGpuUpload(plan->uSrcCrc.data(), plan->uSrcCrc.size());
+    c->rmIdx = batchGpuUpload(plan->rmIdx.data(), plan->rmIdx.size());
+
+    // Device and pinned host rows, streams
+    gpu->plan = plan;
+    gpu->maxB = maxB;
+    gpu->chunk = std::min(chunk, maxB);
+    size_t nInfo = size_t(maxB) * c->nInfoWords, nRm = size_t(maxB) * c->nRmWords;
+    batchGpuCheck(cudaMalloc(&gpu->dInfo, sizeof(uint64_t) * nInfo), "cudaMalloc");
+    batchGpuCheck(cudaMalloc(&gpu->dRnti, sizeof(uint16_t) * maxB), "cudaMalloc");
+    batchGpuCheck(cudaMalloc(&gpu->dRm, sizeof(uint64_t) * nRm), "cudaMalloc");
+    batchGpuCheck(cudaMallocHost(&gpu->info, sizeof(uint64_t) * nInfo), "cudaMallocHost");
+    batchGpuCheck(cudaMallocHost(&gpu->rnti, sizeof(uint16_t) * maxB), "cudaMallocHost");
+    batchGpuCheck(cudaMallocHost(&gpu->rm, sizeof(uint64_t) * nRm), "cudaMallocHost");
+    for (int i = 0; i < nStreams; ++i) {
+        cudaStream_t s;
+        batchGpuCheck(cudaStreamCreateWithFlags(&s, cudaStreamNonBlocking),
+                      "cudaStreamCreate");
+        gpu->streams.push_back(s);
+    }
+}
+
+void batchGpuCreate(batchGpu_s *gpu, std::shared_ptr<const plan_s> plan, int maxB,
+                    int chunk, int nStreams) {
+    if (plan->params.link != LINK_DL)
+        throw std::runtime_error("GPU batch encodes downlink plans only");
+    if (maxB < 1 || chunk < 1 || nStreams < 1)
+        throw std::runtime_error("GPU batch needs maxB, chunk and nStreams >= 1");
+
+    // Null pointers and no streams first, so a failed allocation releases the rest
+    *gpu = batchGpu_s{};
+    try {
+        batchGpuAlloc(gpu, plan, maxB, chunk, nStreams);
+    } catch (...) {
+        batchGpuDestroy(gpu);
+        throw;
+    }
+}
+
+// Null pointers are no-ops for cudaFree and cudaFreeHost, partial encoders are fine
+void batchGpuDestroy(batchGpu_s *gpu) {
+    for (cudaStream_t s : gpu->streams)
+        cudaStreamDestroy(s);
+    cudaFree(const_cast<uint32_t *>(gpu->code.crcTab));
+    cudaFree(const_cast<uint16_t *>(gpu->code.uSrc));
+    cudaFree(const_cast<uint16_t *>(gpu->code.rmIdx));
+    cudaFree(gpu->dInfo);
+    cudaFree(gpu->dRnti);
+    cudaFree(gpu->dRm);
+    cudaFreeHost(gpu->info);
+    cudaFreeHost(gpu->rnti);
+    cudaFreeHost(gpu->rm);
+    *gpu = batchGpu_s{};
+}
+
+void batchGpuEncode(batchGpu_s *gpu, int B, const uint64_t *info, const uint16_t *rnti,
+                    uint64_t *rm) {
+    const batchGpuCode_s *c = &gpu->code;
+    if (B > gpu->maxB)
+        throw std::runtime_error("GPU batch of " + std::to_string(B) +
+                                 " codewords, created for " + std::to_string(gpu->maxB));
+
+    // Copy in, encode and copy out each chunk on its stream, chunks of different
+    // streams overlap
+    int nStreams = int(gpu->streams.size());
+    for (int b0 = 0, k = 0; b0 < B; b0 += gpu->chunk, ++k) {
+        int nb = std::min(gpu->chunk, B - b0);
+        cudaStream_t s = gpu->streams[k % nStreams];
+        size_t iOff = size_t(b0) * c->nInfoWords, rOff = size_t(b0) * c->nRmWords;
+        batchGpuCheck(cudaMemcpyAsync(gpu->dInfo + iOff, info + iOff,
+                                      sizeof(uint64_t) * nb * c->nInfoWords,
+                                      cudaMemcpyHostToDevice, s),
+                      "cudaMemcpyAsync");
+        batchGpuCheck(cudaMemcpyAsync(gpu->dRnti + b0, rnti + b0, sizeof(uint16_t) * nb,
+                                      cudaMemcpyHostToDevice, s),
+                      "cudaMemcpyAsync");
+        batchGpuLaunch(c, nb, gpu->dInfo + iOff, gpu->dRnti + b0, gpu->dRm + rOff, s);
+        batchGpuCheck(cudaMemcpyAsync(rm + rOff, gpu->dRm + rOff,
+                                      sizeof(uint64_t) * nb * c->nRmWords,
+                                      cudaMemcpyDeviceToHost, s),
+                      "cudaMemcpyAsync");
+    }
+    for (cudaStream_t s : gpu->streams)
+        batchGpuCheck(cudaStreamSynchronize(s), "cudaStreamSynchronize");
+}
+
+void batchGpuRun(const std::vector<fs::path> &dirs, int B, int nStreams) {
+    if (!batchGpuAvailable())
+        throw std::runtime_error("no CUDA device");
+    using clock = std::chrono::steady_clock;
+    const int nIter = 10;
+    for (const fs::path &dir : dirs) {
+        polarCfg_s cfg;
+        polarCfgRead(dir, &cfg);
+        if (cfg.params.link != LINK_DL)
+            continue;
+        std::shared_ptr<const plan_s> plan = planGet(planCacheDefault(), &cfg);
+        batchGpu_s gpu;
+        batchGpuCreate(&gpu, plan, B, 4096, nStreams);
+        std::unique_ptr<batchGpu_s, void (*)(batchGpu_s *)> owner(&gpu, batchGpuDestroy);
+
+        // Random payloads straight into the pinned rows
+        int nInfoWords = bvWords(cfg.params.A), nRmWords = bvWords(cfg.params.E);
+        std::mt19937_64 rng(B);
+        for (size_t i = 0; i < size_t(B) * nInfoWords; ++i)
+            gpu.info[i] = rng();
+        for (int b = 0; b < B; ++b)
+            gpu.rnti[b] = uint16_t(rng());
+
+        // GPU against the bit-sliced CPU batch, rows whose info words carry
+        // bits past A encode the same as with them cleared
+        std::vector<uint64_t> cpu(size_t(B) * nRmWords);
+        auto t0 = clock::now();
+        for (int i = 0; i < nIter; ++i)
+            batchEncode(plan.get(), B, gpu.info, gpu.rnti, cpu.data());
+        auto t1 = clock::now();
+        batchGpuEncode(&gpu, B, gpu.info, gpu.rnti, gpu.rm);
+        auto t2 = clock::now();
+        for (int i = 0; i < nIter; ++i)
+            batchGpuEncode(&gpu, B, gpu.info, gpu.rnti, gpu.rm);
+        auto t3 = clock::now();
+
+        int nDiffRows = 0;
+        for (int b = 0; b < B; ++b)
+            nDiffRows += !std::equal(&cpu[size_t(b) * nRmWords],
+                                     &cpu[size_t(b + 1) * nRmWords],
+                                     &gpu.rm[size_t(b) * nRmWords]);
+        auto rate = [&](clock::duration d) {
+            return nIter * double(B) /
+                   std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+        };
+        std::cout << dir.string() << ": B " << B << ", nDiffRows " << nDiffRows
+                  << ", GPU " << rate(t3 - t2) << " Mcw/s, CPU batch " << rate(t1 - t0)
+                  << " Mcw/s" << std::endl;
+    }
+}
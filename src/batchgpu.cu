@@ -0,0 +1,114 @@
+#include "batchgpu.h"
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#ifndef BATCH_GPU_EMULATE
+#include <cuda_runtime.h>
+#endif
+
+// Info + CRC rows of the block's codewords, BATCH_GPU_BLOCK x nCWords
+extern __shared__ uint64_t batchGpuRows[];
+
+// First slice of the CRC table
+__shared__ uint32_t batchGpuTab[256];
+
+__global__ void batchGpuKernel(batchGpuCode_s c, int B, const uint64_t *info,
+                               const uint16_t *rnti, uint64_t *rm) {
+    int tid = threadIdx.x;
+    int b0 = blockIdx.x * BATCH_GPU_BLOCK;
+    int nb = min(BATCH_GPU_BLOCK, B - b0);
+
+    // CRC table and the info rows of the block, coalesced
+    for (int i = tid; i < 256; i += blockDim.x)
+        batchGpuTab[i] = c.crcTab[i];
+    for (int i = tid; i < nb * c.nCWords; i += blockDim.x) {
+        int row = i / c.nCWords, w = i % c.nCWords;
+        batchGpuRows[i] =
+            w < c.nInfoWords ? info[size_t(b0 + row) * c.nInfoWords + w] : 0;
+    }
+    __syncthreads();
+
+    // Thread per codeword: CRC, RNTI scrambling and attachment after bit A-1
+    if (tid < nb) {
+        uint64_t *row = &batchGpuRows[tid * c.nCWords];
+        if (c.A & 63)
+            row[c.nInfoWords - 1] &= (uint64_t{1} << (c.A & 63)) - 1;
+        uint32_t reg = c.onesInit;
+        int nBytes = c.A >> 3;
+        for (int i = 0; i < nBytes; ++i) {
+            uint32_t byte = (row[i >> 3] >> ((i & 7) * 8)) & 0xff;
+            reg = (reg >> 8) ^ batchGpuTab[(reg ^ byte) & 0xff];
+        }
+        for (int i = nBytes * 8; i < c.A; ++i) {
+            uint32_t fb = (reg ^ uint32_t(row[i >> 6] >> (i & 63))) & 1;
+            reg = fb ? (reg >> 1) ^ c.polyRef : reg >> 1;
+        }
+        if (c.P >= 16)
+            reg ^= (__brev(rnti[b0 + tid]) >> 16) << (c.P - 16);
+        int off = c.A >> 6, sh = c.A & 63;
+        row[off] |= uint64_t(reg) << sh;
+        if (sh + c.P > 64)
+            row[off + 1] |= uint64_t(reg) >> (64 - sh);
+    }
+    __syncthreads();
+
+    // Warp per codeword, lane l holds u bits [32 l, 32 l + 32)
+    const unsigned all = 0xffffffffu;
+    int lane = tid & 31, nWarps = blockDim.x >> 5;
+    for (int cw = tid >> 5; cw < nb; cw += nWarps) {
+        const uint64_t *row = &batchGpuRows[cw * c.nCWords];
+
+        // Frozen bit insertion through the composite gather, frozen bits read bit K
+        uint32_t x = 0;
+        for (int b = 0; b < 32; ++b) {
+            int j = 32 * lane + b;
+            if (j < c.N) {
+                int s = __ldg(&c.uSrc[j]);
+                x |= uint32_t((row[s >> 6] >> (s & 63)) & 1) << b;
+            }
+        }
+
+        // Butterfly: strides below 32 inside the lane, larger ones across lanes
+        const uint32_t masks[5] = {0x55555555u, 0x33333333u, 0x0f0f0f0fu, 0x00ff00ffu,
+                                   0x0000ffffu};
+        for (int k = 0, s = 1; k < 5 && s < c.N; ++k, s <<= 1)
+            x ^= (x >> s) & masks[k];
+        for (int d = 1; 32 * d < c.N; d <<= 1) {
+            uint32_t y = __shfl_down_sync(all, x, d);
+            if (!(lane & d))
+                x ^= y;
+        }
+
+        // Rate matching, 32 output bits per lane and step, each shuffled from its lane.
+        // Loop bounds are the same on all lanes, the shuffles need the whole warp.
+        uint32_t *out = reinterpret_cast<uint32_t *>(rm + size_t(b0 + cw) * c.nRmWords);
+        int nOut = 2 * c.nRmWords;
+        for (int o0 = 0; o0 < nOut; o0 += 32) {
+            int o = o0 + lane;
+            uint32_t y = 0;
+            for (int b = 0; b < 32; ++b) {
+                int e = 32 * o + b;
+                int s = e < c.E ? __ldg(&c.rmIdx[e]) : 0;
+                uint32_t v = __shfl_sync(all, x, s >> 5);
+                if (e < c.E)
+                    y |= ((v >> (s & 31)) & 1) << b;
+            }
+            if (o < nOut)
+                out[o] = y;
+        }
+    }
+}
+
+#ifndef BATCH_GPU_EMULATE
+void batchGpuLaunch(const batchGpuCode_s *code, int B, const uint64_t *info,
+                    const uint16_t *rnti, uint64_t *rm, cudaStream_t stream) {
+    int nBlocks = (B + BATCH_GPU_BLOCK - 1) / BATCH_GPU_BLOCK;
+    size_t shared = sizeof(uint64_t) * BATCH_GPU_BLOCK * code->nCWords;
+    batchGpuKernel<<<nBlocks, BATCH_GPU_BLOCK, shared, stream>>>(*code, B, info, rnti,
+                                                                rm);
+    cudaError_t err = cudaGetLastError();
+    if (err != cudaSuccess)
+        throw std::runtime_error(std::string("batchGpuKernel: ") +
+                                 cudaGetErrorString(err));
+}
+#endif
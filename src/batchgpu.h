@@ -0,0 +1,87 @@
+#ifndef BATCHGPU_H_
+#define BATCHGPU_H_
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+// tests/test_gpu.cpp runs the kernel on the CPU with its own stand-ins for the runtime
+#ifndef BATCH_GPU_EMULATE
+#include <cuda_runtime.h>
+#endif
+
+namespace fs = std::filesystem;
+
+// Batched downlink encoding on a CUDA device, built with XT_EX_CUDA. Experimental: not
+// yet compiled with nvcc or run on a device, only a CPU emulation of the kernel
+// (tests/test_gpu.cpp) checks it. Same layouts and plans as batchEncode. Each launch
+// encodes thousands of codewords of one plan:
+//   - one thread per codeword computes the CRC, from a byte table in shared memory;
+//   - one warp per codeword then runs the rest of the chain, each lane holding 32
+//     u-vector bits. Butterfly strides below 32 use masked shifts inside a lane and
+//     larger strides use shuffles between lanes. Rate matching reads every output
+//     bit with a shuffle from the lane that holds it.
+// Calls are split into chunks, placed round robin on the streams. That way the copy
+// in of one chunk overlaps the kernel of another and the copy out of a third.
+
+// Codewords per thread block
+#define BATCH_GPU_BLOCK 128
+
+typedef struct plan_s plan_s;
+
+// What the kernel needs of a plan, device pointers
+typedef struct batchGpuCode_s {
+    int A;
+    int P;
+    int K;
+    int N;
+    int E;
+    int nInfoWords; // bvWords(A)
+    int nCWords;    // bvWords(K + 1), info + CRC bits and the zero bit K of frozen bits
+    int nRmWords;   // bvWords(E)
+    uint32_t onesInit;
+    uint32_t polyRef;
+    const uint32_t *crcTab; // 256, first slice of the plan's table
+    const uint16_t *uSrc;   // N, plan uSrcCrc
+    const uint16_t *rmIdx;  // E, plan rmIdx
+} batchGpuCode_s;
+
+// Encoder of one plan for up to maxB codewords per call. Owns the device tables and
+// buffers, the streams and pinned host rows; one per host thread.
+typedef struct batchGpu_s {
+    std::shared_ptr<const plan_s> plan;
+    batchGpuCode_s code;
+    int maxB;
+    int chunk; // Codewords per launch
+    std::vector<cudaStream_t> streams;
+    uint64_t *dInfo; // Device rows of maxB
+    uint16_t *dRnti;
+    uint64_t *dRm;
+    uint64_t *info; // Pinned host rows of maxB, the layout of batchEncode. Filled
+    uint16_t *rnti; // here, copies overlap the kernels; other host memory works,
+    uint64_t *rm;   // but its copies are staged
+} batchGpu_s;
+
+// A CUDA device is present
+bool batchGpuAvailable();
+
+// Throws for uplink plans or on CUDA errors, like every call below
+void batchGpuCreate(batchGpu_s *gpu, std::shared_ptr<const plan_s> plan, int maxB,
+                    int chunk = 4096, int nStreams = 2);
+void batchGpuDestroy(batchGpu_s *gpu);
+
+// Encode B <= maxB codewords: info holds B rows of bvWords(A) packed words, rnti B
+// values and rm receives B rows of bvWords(E) packed words. Returns when rm is written.
+void batchGpuEncode(batchGpu_s *gpu, int B, const uint64_t *info, const uint16_t *rnti,
+                    uint64_t *rm);
+
+// Kernel launch of B codewords on stream, device pointers (batchgpu.cu)
+void batchGpuLaunch(const batchGpuCode_s *code, int B, const uint64_t *info,
+                    const uint16_t *rnti, uint64_t *rm, cudaStream_t stream);
+
+// B random codewords per test vector configuration on the GPU and with batchEncode:
+// rows that differ and both throughputs
+void batchGpuRun(const std::vector<fs::path> &dirs, int B, int nStreams = 2);
+
+#endif // BATCHGPU_H_
@@ -0,0 +1,81 @@
+#include "bitvec.h"
+#include <algorithm>
+#include <cstdint>
+
+void bvInit(bitvec_s *bv, int nBits) {
+    bv->nBits = nBits;
+    bv->words.assign(bvWords(nBits), 0);
+}
+
+void bvPack(bitvec_s *bv, const int *bits, int nBits) {
+    bvInit(bv, nBits);
+    for (int i = 0; i < nBits; ++i)
+        bv->words[i >> 6] |= uint64_t(bits[i] & 1) << (i & 63);
+}
+
+void bvUnpack(const bitvec_s *bv, int *bits) {
+    for (int i = 0; i < bv->nBits; ++i)
+        bits[i] = bvGet(bv, i);
+}
+
+void bvXor(bitvec_s *dst, const bitvec_s *src) {
+    int n = std::min(dst->words.size(), src->words.size());
+    for (int w = 0; w < n; ++w)
+        dst->words[w] ^= src->words[w];
+}
+
+int bvPopcount(const bitvec_s *bv) {
+    int cnt = 0;
+    for (uint64_t w : bv->words)
+        cnt += __builtin_popcountll(w);
+    return cnt;
+}
+
+int bvDot(const bitvec_s *a, const bitvec_s *b) {
+    uint64_t acc = 0;
+    int n = std::min(a->words.size(), b->words.size());
+    for (int w = 0; w < n; ++w)
+        acc ^= a->words[w] & b->words[w];
+    return __builtin_parityll(acc);
+}
+
+void bvConcat(const bitvec_s *a, const bitvec_s *b, bitvec_s *out) {
+    bvInit(out, a->nBits + b->nBits);
+    std::copy(a->words.begin(), a->words.end(), out->words.begin());
+    int off = a->nBits >> 6;
+    int sh = a->nBits & 63;
+    for (int w = 0; w < (int)b->words.size(); ++w) {
+        out->words[off + w] |= b->words[w] << sh;
+        if (sh && off + w + 1 < (int)out->words.size())
+            out->words[off + w + 1] |= b->words[w] >> (64 - sh);
+    }
+}
+
+void bvGather(const bitvec_s *src, const int *idx, int n, bitvec_s *dst) {
+    bvInit(dst, n);
+    for (int i = 0; i < n; ++i)
+        dst->words[i >> 6] |= uint64_t(bvGet(src, idx[i])) << (i & 63);
+}
+
+void bvScatter(const bitvec_s *src, const int *idx, int n, bitvec_s *dst) {
+    for (int i = 0; i < n; ++i)
+        bvSet(dst, idx[i], bvGet(src, i));
+}
+
+void bvTranspose64(uint64_t *a) {
+    // Swap off-diagonal blocks of 32, 16, ..., 1 bits
+    uint64_t m = 0x00000000ffffffffull;
+    for (int j = 32; j != 0; j >>= 1, m ^= m << j) {
+        for (int k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+            uint64_t t = ((a[k] >> j) ^ a[k | j]) & m;
+            a[k] ^= t << j;
+            a[k | j] ^= t;
+        }
+    }
+}
+
+void bvCrcMtx(const bitvec_s *msg, const bitvec_s *genCols, int P, bitvec_s *crc) {
+    bvInit(crc, P);
+    for (int j = 0; j < P; ++j)
+        crc->words[j >> 6] |= uint64_t(bvDot(msg, &genCols[j])) << (j & 63);
+}
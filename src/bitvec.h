@@ -0,0 +1,42 @@
+#ifndef BITVEC_H_
+#define BITVEC_H_
+
+#include <cstdint>
+#include <vector>
+
+// Packed bit vector, bit i in word i / 64 at position i % 64 (LSB first).
+// Unused bits of the last word are kept zero.
+typedef struct bitvec_s {
+    int nBits;
+    std::vector<uint64_t> words;
+} bitvec_s;
+
+inline int bvWords(int nBits) { return (nBits + 63) >> 6; }
+
+inline int bvGet(const bitvec_s *bv, int i) {
+    return (bv->words[i >> 6] >> (i & 63)) & 1;
+}
+
+inline void bvSet(bitvec_s *bv, int i, int b) {
+    uint64_t m = uint64_t{1} << (i & 63);
+    bv->words[i >> 6] = (bv->words[i >> 6] & ~m) | (b ? m : 0);
+}
+
+void bvInit(bitvec_s *bv, int nBits);
+void bvPack(bitvec_s *bv, const int *bits, int nBits);
+void bvUnpack(const bitvec_s *bv, int *bits);
+
+void bvXor(bitvec_s *dst, const bitvec_s *src);
+int bvPopcount(const bitvec_s *bv);
+int bvDot(const bitvec_s *a, const bitvec_s *b);
+void bvConcat(const bitvec_s *a, const bitvec_s *b, bitvec_s *out);
+void bvGather(const bitvec_s *src, const int *idx, int n, bitvec_s *dst);
+void bvScatter(const bitvec_s *src, const int *idx, int n, bitvec_s *dst);
+
+// In-place 64 x 64 bit matrix transpose, bit j of a[i] moves to bit i of a[j]
+void bvTranspose64(uint64_t *a);
+
+// CRC of msg with the generator matrix given as P packed columns of length K
+void bvCrcMtx(const bitvec_s *msg, const bitvec_s *genCols, int P, bitvec_s *crc);
+
+#endif // BITVEC_H_
@@ -0,0 +1,377 @@
+#include "blind.h"
+#include "awgn.h"
+#include "bitvec.h"
+#include "decdl.h"
+#include "plan.h"
+#include "polarcfg.h"
+#include "pool.h"
+#include "prof.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Decoder input: LLR * 16, saturated, as in the simulator
+#define BLIND_LLR_SCALE 16.0f
+#define BLIND_LLR_MAX 4095
+
+static inline int16_t blindQuant(float llr) {
+    float q = std::nearbyint(llr * BLIND_LLR_SCALE);
+    return int16_t(std::min<float>(std::max<float>(q, -BLIND_LLR_MAX), BLIND_LLR_MAX));
+}
+
+void blindDefaults(blindCfg_s *cfg) {
+    cfg->nCce = 48;
+    cfg->coreset = 1;
+    cfg->common = false;
+    const int nCand[BLIND_N_AL] = {6, 6, 2, 2, 1};
+    std::copy(nCand, nCand + BLIND_N_AL, cfg->nCand);
+    cfg->sizes = {40, 60};
+    cfg->L = DEC_L_MAX;
+    cfg->pmMax = 0.15f;
+    cfg->maxHits = 1;
+    cfg->nThreads = 0;
+}
+
+// Claim tasks of the current pass until none are left
+static void blindWork(blind_s *bd, int worker) {
+    for (int t; (t = bd->next.fetch_add(1, std::memory_order_relaxed)) < bd->nTasks;)
+        (*bd->fn)(t, worker);
+}
+
+static void blindWorker(blind_s *bd, int worker) {
+    if (profOn())
+        profThreadInit();
+    uint64_t pass = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(bd->mtx);
+            bd->start.wait(lock, [&]() { return bd->stop || bd->pass != pass; });
+            if (bd->stop)
+                return;
+            pass = bd->pass;
+        }
+        blindWork(bd, worker);
+        std::lock_guard<std::mutex> lock(bd->mtx);
+        if (--bd->nBusy == 0)
+            bd->idle.notify_one();
+    }
+}
+
+// Run fn(task, worker) for tasks 0..nTasks-1 on the workers and the caller, and wait
+// for all of them
+static void blindParallel(blind_s *bd, int nTasks,
+                          const std::function<void(int, int)> &fn) {
+    {
+        std::lock_guard<std::mutex> lock(bd->mtx);
+        bd->fn = &fn;
+        bd->nTasks = nTasks;
+        bd->next.store(0, std::memory_order_relaxed);
+        bd->nBusy = bd->threads.size();
+        ++bd->pass;
+    }
+    bd->start.notify_all();
+    blindWork(bd, 0);
+    std::unique_lock<std::mutex> lock(bd->mtx);
+    bd->idle.wait(lock, [&]() { return bd->nBusy == 0; });
+}
+
+void blindCreate(blind_s *bd, const blindCfg_s *cfg) {
+    if (cfg->nCce < 1 || cfg->nCce > 256 || cfg->sizes.empty())
+        throw std::runtime_error("invalid search space");
+    bd->cfg = *cfg;
+    bd->nWorkers = poolThreads(cfg->nThreads);
+    int nSizes = cfg->sizes.size(), nCodes = BLIND_N_AL * nSizes;
+
+    // One plan per level and size, the sizes a level cannot carry are left out
+    bd->codes.assign(nCodes, {});
+    for (int al = 0; al < BLIND_N_AL; ++al)
+        for (int s = 0; s < nSizes; ++s) {
+            int A = cfg->sizes[s], E = BLIND_CCE_BITS << al;
+            if (A < 1 || A > PAT_K_IL_MAX - 24)
+                throw std::runtime_error("invalid DCI size " + std::to_string(A));
+            if (E < A + 24 || cfg->nCand[al] == 0 || (1 << al) > cfg->nCce)
+                continue;
+            polarCfg_s pc;
+            polarCfgMake(&pc, A, E, LINK_DL);
+            bd->codes[al * nSizes + s].plan = planGet(planCacheDefault(), &pc);
+        }
+
+    // Decoders, tables shared through the plans
+    bd->dec.assign(size_t(bd->nWorkers) * nCodes, {});
+    for (int w = 0; w < bd->nWorkers; ++w)
+        for (int c = 0; c < nCodes; ++c)
+            if (bd->codes[c].plan)
+                decCreate(&bd->dec[w * nCodes + c], bd->codes[c].plan);
+    int nCandMax = 0;
+    for (int al = 0; al < BLIND_N_AL; ++al)
+        nCandMax += cfg->nCand[al];
+    bd->ch.assign(size_t(nCandMax) * nSizes * PLAN_N_MAX, 0);
+
+    // Codes of a level with equal N, gather and shortened bits have the same
+    // channel LLRs
+    for (int al = 0; al < BLIND_N_AL; ++al)
+        for (int s = 0; s < nSizes; ++s) {
+            int c = al * nSizes + s;
+            bd->codes[c].derm = c;
+            for (int t = 0; t < s && bd->codes[c].plan; ++t) {
+                int d = al * nSizes + t;
+                const plan_s *a = bd->codes[c].plan.get(), *b = bd->codes[d].plan.get();
+                if (b && a->params.N == b->params.N && a->rmIdx == b->rmIdx &&
+                    bd->dec[c].shortIdx == bd->dec[d].shortIdx) {
+                    bd->codes[c].derm = bd->codes[d].derm;
+                    break;
+                }
+            }
+        }
+
+    // Workers, idle until a search hands them a pass
+    bd->pass = 0;
+    bd->nBusy = 0;
+    bd->stop = false;
+    bd->threads.clear();
+    for (int w = 1; w < bd->nWorkers; ++w)
+        bd->threads.emplace_back(blindWorker, bd, w);
+}
+
+void blindDestroy(blind_s *bd) {
+    {
+        std::lock_guard<std::mutex> lock(bd->mtx);
+        bd->stop = true;
+    }
+    bd->start.notify_all();
+    for (std::thread &t : bd->threads)
+        t.join();
+    bd->threads.clear();
+}
+
+void blindCandidates(const blindCfg_s *cfg, uint16_t rnti, int slot,
+                     std::vector<blindCand_s> *cands) {
+    // Y_p,n = A_p Y_p,n-1 mod D from Y_p,-1 = n_RNTI, 0 for a common search space
+    static const uint32_t A_P[3] = {39827, 39829, 39839};
+    uint32_t y = 0;
+    if (!cfg->common) {
+        y = rnti;
+        for (int n = 0; n <= slot; ++n)
+            y = uint32_t(uint64_t(A_P[cfg->coreset % 3]) * y % 65537);
+    }
+    cands->clear();
+    for (int al = 0; al < BLIND_N_AL; ++al) {
+        int L = 1 << al, nPos = cfg->nCce / L;
+        int M = std::min(cfg->nCand[al], nPos);
+        for (int m = 0; m < M; ++m)
+            cands->push_back({al, L * int((y + m * cfg->nCce / (L * M)) % nPos)});
+    }
+}
+
+int blindSearch(blind_s *bd, const int16_t *llr, uint16_t rnti, int slot,
+                std::vector<blindHit_s> *hits, blindStats_s *stats) {
+    const blindCfg_s *cfg = &bd->cfg;
+    const int nSizes = cfg->sizes.size(), nCodes = bd->codes.size();
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<blindCand_s> cands;
+    blindCandidates(cfg, rnti, slot, &cands);
+
+    std::mutex mtx;
+    std::vector<int> pending; // CA-SCL pass, candidate * nSizes + size
+    std::atomic<int> nHits{0};
+    std::atomic<int64_t> nDecodes{0}, nDerm{0}, nSc{0}, nRejected{0}, nList{0},
+        nSkipped{0};
+    hits->clear();
+    auto done = [&]() {
+        return cfg->maxHits > 0 && nHits.load(std::memory_order_relaxed) >= cfg->maxHits;
+    };
+    auto hit = [&](const blindHit_s &h) {
+        std::lock_guard<std::mutex> lock(mtx);
+        hits->push_back(h);
+        nHits.fetch_add(1, std::memory_order_relaxed);
+    };
+
+    // SC pass, one task per candidate. Its LLRs are de-rate-matched once per group of
+    // codes sharing the rate matching, every size decodes from them and they are kept
+    // for the CA-SCL pass.
+    auto chOf = [&](int task, int code) {
+        size_t i = size_t(task) * nSizes + bd->codes[code].derm % nSizes;
+        return &bd->ch[i * PLAN_N_MAX];
+    };
+    blindParallel(bd, cands.size(), [&](int task, int worker) {
+        const blindCand_s &c = cands[task];
+        const int16_t *in = llr + c.cce * BLIND_CCE_BITS;
+        int16_t *ch = nullptr;
+        int chCode = -1;
+        int64_t sumAbs = 0; // Channel LLRs, shortened bits left out
+        for (int s = 0; s < nSizes; ++s) {
+            int code = c.al * nSizes + s;
+            const blindCode_s *bc = &bd->codes[code];
+            if (!bc->plan)
+                continue;
+            nDecodes.fetch_add(1, std::memory_order_relaxed);
+            if (done()) {
+                nSkipped.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            dec_s *dec = &bd->dec[size_t(worker) * nCodes + code];
+            if (bc->derm != chCode) {
+                ch = chOf(task, code);
+                decDerm16(dec, in, ch);
+                chCode = bc->derm;
+                sumAbs = 0;
+                for (int i = 0; i < bc->plan->params.N; ++i)
+                    sumAbs += ch[i] == INT16_MAX ? 0 : std::abs(ch[i]);
+                nDerm.fetch_add(1, std::memory_order_relaxed);
+            }
+            blindHit_s h = {s, c.al, c.cce, false, 0, {}};
+            nSc.fetch_add(1, std::memory_order_relaxed);
+            if (decDecodeCh16(dec, ch, 1, rnti, h.info)) {
+                h.pm = dec->pm;
+                hit(h);
+            } else if (cfg->L <= 1 || dec->pm > cfg->pmMax * sumAbs) {
+                nRejected.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                std::lock_guard<std::mutex> lock(mtx);
+                pending.push_back(task * nSizes + s);
+            }
+        }
+    });
+
+    // CA-SCL pass of the candidates SC could neither accept nor drop, from their
+    // channel LLRs of the SC pass
+    std::sort(pending.begin(), pending.end());
+    auto list = [&](int task, int worker) {
+        if (done()) {
+            nSkipped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        int cand = pending[task] / nSizes, s = pending[task] % nSizes;
+        int code = cands[cand].al * nSizes + s;
+        const blindCand_s &c = cands[cand];
+        dec_s *dec = &bd->dec[size_t(worker) * nCodes + code];
+        blindHit_s h = {s, c.al, c.cce, true, 0, {}};
+        nList.fetch_add(1, std::memory_order_relaxed);
+        if (decDecodeCh16(dec, chOf(cand, code), cfg->L, rnti, h.info)) {
+            h.pm = dec->pm;
+            hit(h);
+        }
+    };
+    if (!pending.empty())
+        blindParallel(bd, pending.size(), list);
+
+    std::sort(hits->begin(), hits->end(), [](const blindHit_s &a, const blindHit_s &b) {
+        if (a.cce != b.cce)
+            return a.cce < b.cce;
+        return a.al != b.al ? a.al < b.al : a.size < b.size;
+    });
+    auto t1 = std::chrono::steady_clock::now();
+    stats->nCand += cands.size();
+    stats->nDecodes += nDecodes.load();
+    stats->nDerm += nDerm.load();
+    stats->nSc += nSc.load();
+    stats->nRejected += nRejected.load();
+    stats->nList += nList.load();
+    stats->nSkipped += nSkipped.load();
+    stats->nHits += hits->size();
+    stats->ns += std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+    return hits->size();
+}
+
+void blindTx(const blind_s *bd, uint16_t rnti, int slot, double snrDb, uint64_t seed,
+             int16_t *llr, blindHit_s *tx) {
+    const blindCfg_s *cfg = &bd->cfg;
+    const int nSizes = cfg->sizes.size(), nLlr = cfg->nCce * BLIND_CCE_BITS;
+    std::mt19937_64 rng(seed ^ (uint64_t(slot) * 0xd1342543de82ef95ull));
+
+    // Candidate and size, among the codes the search space has
+    std::vector<blindCand_s> cands;
+    blindCandidates(cfg, rnti, slot, &cands);
+    std::vector<int> choices; // Candidate * nSizes + size
+    for (int i = 0; i < (int)cands.size(); ++i)
+        for (int s = 0; s < nSizes; ++s)
+            if (bd->codes[cands[i].al * nSizes + s].plan)
+                choices.push_back(i * nSizes + s);
+    if (choices.empty())
+        throw std::runtime_error("search space without candidates");
+    int pick = choices[rng() % choices.size()];
+    const blindCand_s &c = cands[pick / nSizes];
+    const plan_s *plan = bd->codes[c.al * nSizes + pick % nSizes].plan.get();
+    *tx = {pick % nSizes, c.al, c.cce, false, 0, {}};
+
+    // Payload and encoding
+    int A = plan->params.A, E = plan->params.E;
+    for (int w = 0; w < bvWords(A); ++w)
+        tx->info[w] = rng();
+    if (A & 63)
+        tx->info[bvWords(A) - 1] &= (uint64_t{1} << (A & 63)) - 1;
+    std::vector<uint64_t> rm(bvWords(E));
+    planEncode(plan, tx->info, rnti, rm.data());
+
+    // QPSK of unit energy on the candidate, noise everywhere, N0 = 2 sigma^2
+    float s2 = float(0.5 / std::pow(10.0, snrDb / 10));
+    std::vector<float> noise(nLlr);
+    awgn_s awgn;
+    awgnInit(&awgn, seed, slot);
+    awgnReal(&awgn, noise.data(), nLlr, std::sqrt(s2));
+    float g = 2.0f * 0.70710678f / s2;
+    for (int i = 0; i < nLlr; ++i) {
+        int e = i - c.cce * BLIND_CCE_BITS;
+        float x = 0.0f;
+        if (e >= 0 && e < E)
+            x = 0.70710678f * (1.0f - 2.0f * float((rm[e >> 6] >> (e & 63)) & 1));
+        llr[i] = blindQuant(g * (x + noise[i]));
+    }
+}
+
+void blindRun(const blindCfg_s *cfg, double snrDb, int nSlots) {
+    blind_s bd;
+    blindCreate(&bd, cfg);
+    std::vector<int16_t> llr(cfg->nCce * BLIND_CCE_BITS);
+    std::vector<blindHit_s> hits;
+    blindStats_s stats{};
+    int64_t nDetected = 0, nMissed = 0, nFalse = 0;
+    std::mt19937 rng(0x5eed);
+    try {
+        for (int slot = 0; slot < nSlots; ++slot) {
+            // Slot numbers of a 30 kHz frame, the hashing repeats every frame
+            uint16_t rnti = uint16_t(1 + rng() % 0xfff0);
+            blindHit_s tx;
+            blindTx(&bd, rnti, slot % 20, snrDb, 0x5eed + slot, llr.data(), &tx);
+            blindSearch(&bd, llr.data(), rnti, slot % 20, &hits, &stats);
+            // A DCI at level 8 also decodes at level 16 on the same first CCE where the
+            // rate matching repeats it, either counts
+            bool found = false;
+            for (const blindHit_s &h : hits) {
+                bool same = h.size == tx.size &&
+                            std::equal(h.info, h.info + BLIND_INFO_WORDS, tx.info);
+                found |= same;
+                nFalse += !same;
+            }
+            nDetected += found;
+            nMissed += !found;
+        }
+    } catch (...) {
+        blindDestroy(&bd);
+        throw;
+    }
+    blindDestroy(&bd);
+
+    double us = stats.ns / 1e3;
+    std::cout << "nSlots: " << nSlots << ", nDetected: " << nDetected
+              << ", nMissed: " << nMissed << ", nFalse: " << nFalse << std::endl;
+    std::cout << "nCand: " << stats.nCand << ", nDecodes: " << stats.nDecodes
+              << ", nDerm: " << stats.nDerm << ", nSc: " << stats.nSc
+              << ", nRejected: " << stats.nRejected << ", nList: " << stats.nList
+              << ", nSkipped: " << stats.nSkipped << std::endl;
+    std::cout << "threads: " << bd.nWorkers << ", " << us / nSlots << " us/slot, "
+              << stats.nDecodes / (us * 1e-6) << " candidates/s" << std::endl;
+}
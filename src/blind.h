@@ -0,0 +1,125 @@
+#ifndef BLIND_H_
+#define BLIND_H_
+
+#include "decdl.h"
+#include "pattern.h"
+#include "plan.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// PDCCH blind decoding: every candidate of a search space (38.213 10.1) decoded for
+// every DCI size with the RNTI of the UE. Codes of one aggregation level that share
+// the rate matching share one de-rate-matching per candidate. A plain SC pass accepts
+// a candidate whose CRC passes and drops one whose path metric is high, only the rest
+// go through CA-SCL from the same channel LLRs. Both passes run on workers started
+// with the search space.
+
+// Aggregation levels 1, 2, 4, 8 and 16. A CCE is 6 REGs of 9 QPSK data REs.
+#define BLIND_N_AL 5
+#define BLIND_CCE_BITS 108
+
+// Info words of the largest DCI
+#define BLIND_INFO_WORDS ((PAT_K_IL_MAX - 24 + 63) / 64)
+
+typedef struct blindCfg_s {
+    int nCce;               // CORESET size
+    int coreset;            // CORESET id p, selects A_p of the hashing
+    bool common;            // Common search space, Y = 0
+    int nCand[BLIND_N_AL];  // Candidates per aggregation level
+    std::vector<int> sizes; // DCI payload sizes A
+    int L;                  // List size of the second pass, 1 for SC only
+    float pmMax;            // Drop when the SC path metric exceeds pmMax * sum |LLR|
+    int maxHits;            // Stop the search after this many DCIs, 0 = all candidates
+    int nThreads;           // 0 = all cores
+} blindCfg_s;
+
+// Candidate of aggregation level 1 << al at CCE cce, its LLRs start at
+// cce * BLIND_CCE_BITS
+typedef struct blindCand_s {
+    int al;
+    int cce;
+} blindCand_s;
+
+typedef struct blindHit_s {
+    int size; // Index into sizes
+    int al;
+    int cce;
+    bool list;  // Found by the CA-SCL pass
+    int32_t pm; // Path metric of the decoded path
+    uint64_t info[BLIND_INFO_WORDS];
+} blindHit_s;
+
+// Counts of blindSearch, added up over calls
+typedef struct blindStats_s {
+    int64_t nCand;     // Candidates
+    int64_t nDecodes;  // Candidate and DCI size pairs
+    int64_t nDerm;     // De-rate-matchings, one per group of codes sharing it
+    int64_t nSc;       // SC passes
+    int64_t nRejected; // Dropped on the SC path metric
+    int64_t nList;     // CA-SCL passes
+    int64_t nSkipped;  // Left out after maxHits
+    int64_t nHits;
+    int64_t ns;        // Search time
+} blindStats_s;
+
+// Code of one aggregation level and DCI size
+typedef struct blindCode_s {
+    std::shared_ptr<const plan_s> plan; // nullptr when the size does not fit the level
+    int derm; // First code of the level with the same rate matching
+} blindCode_s;
+
+typedef struct blind_s {
+    blindCfg_s cfg;
+    int nWorkers;
+    std::vector<blindCode_s> codes; // BLIND_N_AL x sizes
+    std::vector<dec_s> dec;         // nWorkers x codes, decoders are single threaded
+    std::vector<int16_t> ch; // Candidates x sizes x PLAN_N_MAX channel LLRs by derm code
+
+    // Workers 1 .. nWorkers - 1 wait for the tasks of a pass, the caller is worker 0
+    std::vector<std::thread> threads;
+    std::mutex mtx;
+    std::condition_variable start, idle;
+    uint64_t pass; // Passes handed out so far
+    int nBusy;     // Workers still on the current pass
+    bool stop;
+    const std::function<void(int, int)> *fn; // fn(task, worker) of the current pass
+    int nTasks;
+    std::atomic<int> next; // Next task to claim
+} blind_s;
+
+// 48 CCEs, USS of CORESET 1 with 6, 6, 2, 2, 1 candidates, DCI sizes 40 and 60, L = 8,
+// pmMax 0.15 (no detection loss down to 0 dB Es/N0), stop at the first DCI
+void blindDefaults(blindCfg_s *cfg);
+
+// Plans and per worker decoders of every code, then start the workers. Throws on an
+// invalid search space.
+void blindCreate(blind_s *bd, const blindCfg_s *cfg);
+
+// Stop and join the workers
+void blindDestroy(blind_s *bd);
+
+// Candidates of the slot by the hashing function of 38.213 10.1 (n_CI = 0)
+void blindCandidates(const blindCfg_s *cfg, uint16_t rnti, int slot,
+                     std::vector<blindCand_s> *cands);
+
+// Search nCce * BLIND_CCE_BITS LLRs (positive for bit 0) of the CORESET for DCIs
+// scrambled with rnti. Hits come out ordered by CCE, level and size. Returns the
+// number of hits.
+int blindSearch(blind_s *bd, const int16_t *llr, uint16_t rnti, int slot,
+                std::vector<blindHit_s> *hits, blindStats_s *stats);
+
+// Test slot: one DCI of random size and payload on a random candidate, QPSK at Es/N0
+// snrDb, every other CCE noise only. Writes the CORESET LLRs and the transmitted DCI.
+void blindTx(const blind_s *bd, uint16_t rnti, int slot, double snrDb, uint64_t seed,
+             int16_t *llr, blindHit_s *tx);
+
+// nSlots test slots: detections, misses, false alarms and the candidate rate
+void blindRun(const blindCfg_s *cfg, double snrDb, int nSlots);
+
+#endif // BLIND_H_
@@ -0,0 +1,108 @@
+#include "crc.h"
+#include "bitvec.h"
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CRC_CLMUL_X86
+#elif defined(__aarch64__) && defined(__linux__)
+#include <arm_neon.h>
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#define CRC_CLMUL_ARM
+#endif
+
+const crcTable_s *crcSelect(int L) {
+    switch (L) {
+    case 24:
+        return &CRC24C;
+    case 11:
+        return &CRC11;
+    case 6:
+        return &CRC6;
+    default:
+        return nullptr;
+    }
+}
+
+#if defined(CRC_CLMUL_X86)
+
+bool crcHasClmul() { return __builtin_cpu_supports("pclmul"); }
+
+__attribute__((target("pclmul,sse4.1"))) uint32_t
+crcUpdateClmul(const crcTable_s *tab, uint32_t reg, const uint64_t *words, int nBits) {
+    int nWords = nBits >> 6;
+    if (nWords > 0) {
+        const __m128i kFold = _mm_set_epi64x(tab->kFold64, tab->kFold96);
+        const __m128i kBar = _mm_set_epi64x(tab->kPoly, tab->kMu);
+
+        // Fold 64 bits per step: x = x_lo * (D^96 mod g) + x_hi * (D^64 mod g) + w
+        uint64_t x = words[0] ^ reg;
+        for (int w = 1; w < nWords; ++w) {
+            __m128i xv = _mm_set_epi64x(x >> 32, x & 0xffffffff);
+            __m128i a = _mm_clmulepi64_si128(xv, kFold, 0x00);
+            __m128i b = _mm_clmulepi64_si128(xv, kFold, 0x11);
+            x = _mm_cvtsi128_si64(_mm_xor_si128(a, b)) ^ words[w];
+        }
+
+        // Barrett reduction of x * D^L mod g
+        __m128i c1 = _mm_clmulepi64_si128(_mm_cvtsi64_si128(x), kBar, 0x00);
+        uint64_t q = x ^ (_mm_cvtsi128_si64(c1) << 1);
+        __m128i c2 = _mm_clmulepi64_si128(_mm_cvtsi64_si128(q), kBar, 0x10);
+        uint64_t hi = _mm_extract_epi64(c2, 1);
+        reg = (hi >> (63 - tab->L)) & ((uint64_t{1} << tab->L) - 1);
+    }
+    if (nBits & 63)
+        reg = crcUpdateTail(tab, reg, words[nWords], nBits & 63);
+    return reg;
+}
+
+#elif defined(CRC_CLMUL_ARM)
+
+bool crcHasClmul() { return getauxval(AT_HWCAP) & HWCAP_PMULL; }
+
+__attribute__((target("+crypto"))) static inline uint64_t
+clmulLo(uint64_t a, uint64_t b) {
+    return vgetq_lane_u64(vreinterpretq_u64_p128(vmull_p64(a, b)), 0);
+}
+
+__attribute__((target("+crypto"))) static inline uint64_t
+clmulHi(uint64_t a, uint64_t b) {
+    return vgetq_lane_u64(vreinterpretq_u64_p128(vmull_p64(a, b)), 1);
+}
+
+__attribute__((target("+crypto"))) uint32_t
+crcUpdateClmul(const crcTable_s *tab, uint32_t reg, const uint64_t *words, int nBits) {
+    int nWords = nBits >> 6;
+    if (nWords > 0) {
+        // Fold 64 bits per step: x = x_lo * (D^96 mod g) + x_hi * (D^64 mod g) + w
+        uint64_t x = words[0] ^ reg;
+        for (int w = 1; w < nWords; ++w)
+            x = clmulLo(x & 0xffffffff, tab->kFold96) ^ clmulLo(x >> 32, tab->kFold64) ^
+                words[w];
+
+        // Barrett reduction of x * D^L mod g
+        uint64_t q = x ^ (clmulLo(x, tab->kMu) << 1);
+        uint64_t hi = clmulHi(q, tab->kPoly);
+        reg = (hi >> (63 - tab->L)) & ((uint64_t{1} << tab->L) - 1);
+    }
+    if (nBits & 63)
+        reg = crcUpdateTail(tab, reg, words[nWords], nBits & 63);
+    return reg;
+}
+
+#else
+
+bool crcHasClmul() { return false; }
+
+uint32_t crcUpdateClmul(const crcTable_s *tab, uint32_t reg, const uint64_t *words,
+                        int nBits) {
+    return crcUpdateTable(tab, reg, words, nBits);
+}
+
+#endif
+
+void crcAttach(const crcTable_s *tab, const bitvec_s *msg, bitvec_s *crc) {
+    bvInit(crc, tab->L);
+    crc->words[0] = crcUpdate(tab, tab->onesInit, msg->words.data(), msg->nBits);
+}
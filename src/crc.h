@@ -0,0 +1,141 @@
+#ifndef CRC_H_
+#define CRC_H_
+
+#include "bitvec.h"
+#include <cstdint>
+
+// Slice-by-8 tables for an L-bit CRC, 38.212 5.1. The register is kept reflected so
+// that it matches the packed bit order: CRC bit p_i (p_0 first) is register bit i.
+typedef struct crcTable_s {
+    int L;
+    uint32_t poly;     // Generator polynomial without D^L, MSB is D^(L-1)
+    uint32_t polyRef;  // Reflected polynomial
+    uint32_t onesInit; // Register state after L leading ones
+    uint32_t t[8][256];
+    uint64_t kFold96; // Reflected D^96 mod g(D), 33 bits
+    uint64_t kFold64; // Reflected D^64 mod g(D), 33 bits
+    uint64_t kMu;     // Reflected floor(D^(64+L) / g(D)) without D^64
+    uint64_t kPoly;   // Reflected g(D) without D^L, 64 bits
+} crcTable_s;
+
+constexpr uint32_t crcReflect(uint32_t x, int L) {
+    uint32_t r = 0;
+    for (int i = 0; i < L; ++i)
+        r |= ((x >> i) & 1) << (L - 1 - i);
+    return r;
+}
+
+constexpr uint64_t crcReflect64(uint64_t x, int n) {
+    uint64_t r = 0;
+    for (int i = 0; i < n; ++i)
+        r |= ((x >> i) & 1) << (n - 1 - i);
+    return r;
+}
+
+// D^e mod g(D)
+constexpr uint64_t crcPolyMod(int e, int L, uint32_t poly) {
+    uint64_t r = 1;
+    for (int i = 0; i < e; ++i) {
+        r <<= 1;
+        if ((r >> L) & 1)
+            r ^= (uint64_t{1} << L) | poly;
+    }
+    return r;
+}
+
+// floor(D^(64+L) / g(D)) without the D^64 term
+constexpr uint64_t crcPolyMu(int L, uint32_t poly) {
+    uint64_t r = 0, q = 0;
+    for (int i = 64 + L; i >= 0; --i) {
+        r = (r << 1) | (i == 64 + L);
+        if ((r >> L) & 1) {
+            r ^= (uint64_t{1} << L) | poly;
+            if (i < 64)
+                q |= uint64_t{1} << i;
+        }
+    }
+    return q;
+}
+
+constexpr crcTable_s crcMakeTable(int L, uint32_t poly) {
+    crcTable_s tab{L, poly, crcReflect(poly, L), 0, {}, 0, 0, 0, 0};
+    for (int i = 0; i < 256; ++i) {
+        uint32_t r = i;
+        for (int k = 0; k < 8; ++k)
+            r = (r & 1) ? (r >> 1) ^ tab.polyRef : r >> 1;
+        tab.t[0][i] = r;
+    }
+    for (int s = 1; s < 8; ++s)
+        for (int i = 0; i < 256; ++i)
+            tab.t[s][i] = (tab.t[s - 1][i] >> 8) ^ tab.t[0][tab.t[s - 1][i] & 0xff];
+    for (int i = 0; i < L; ++i) {
+        uint32_t fb = (tab.onesInit ^ 1) & 1;
+        tab.onesInit = fb ? (tab.onesInit >> 1) ^ tab.polyRef : tab.onesInit >> 1;
+    }
+    tab.kFold96 = crcReflect64(crcPolyMod(96, L, poly), 33);
+    tab.kFold64 = crcReflect64(crcPolyMod(64, L, poly), 33);
+    tab.kMu = crcReflect64(crcPolyMu(L, poly), 64);
+    tab.kPoly = crcReflect64(poly, 64);
+    return tab;
+}
+
+// NR polynomials, tables generated at compile time
+inline constexpr crcTable_s CRC24C = crcMakeTable(24, 0xb2b117);
+inline constexpr crcTable_s CRC11 = crcMakeTable(11, 0x621);
+inline constexpr crcTable_s CRC6 = crcMakeTable(6, 0x21);
+
+// Table for CRC length L (6, 11 or 24), nullptr otherwise
+const crcTable_s *crcSelect(int L);
+
+// Byte-wise and bit-wise over the last nTail < 64 bits
+inline uint32_t crcUpdateTail(const crcTable_s *tab, uint32_t reg, uint64_t tail,
+                              int nTail) {
+    for (; nTail >= 8; nTail -= 8, tail >>= 8)
+        reg = (reg >> 8) ^ tab->t[0][(reg ^ tail) & 0xff];
+    for (; nTail > 0; --nTail, tail >>= 1) {
+        uint32_t fb = (reg ^ tail) & 1;
+        reg = fb ? (reg >> 1) ^ tab->polyRef : reg >> 1;
+    }
+    return reg;
+}
+
+// Slice-by-8 table kernel, inline for the short messages of DCI and UCI
+inline uint32_t crcUpdateTable(const crcTable_s *tab, uint32_t reg, const uint64_t *words,
+                               int nBits) {
+    // Slice-by-8 over full words
+    int nWords = nBits >> 6;
+    for (int w = 0; w < nWords; ++w) {
+        uint64_t x = words[w] ^ reg;
+        reg = tab->t[7][x & 0xff] ^ tab->t[6][(x >> 8) & 0xff] ^
+              tab->t[5][(x >> 16) & 0xff] ^ tab->t[4][(x >> 24) & 0xff] ^
+              tab->t[3][(x >> 32) & 0xff] ^ tab->t[2][(x >> 40) & 0xff] ^
+              tab->t[1][(x >> 48) & 0xff] ^ tab->t[0][x >> 56];
+    }
+    if (nBits & 63)
+        reg = crcUpdateTail(tab, reg, words[nWords], nBits & 63);
+    return reg;
+}
+
+// Folding kernel with carry-less multiply and Barrett reduction, one fold per word.
+// Only valid when crcHasClmul() is true.
+bool crcHasClmul();
+uint32_t crcUpdateClmul(const crcTable_s *tab, uint32_t reg, const uint64_t *words,
+                        int nBits);
+
+typedef uint32_t (*crcUpdate_f)(const crcTable_s *, uint32_t, const uint64_t *, int);
+
+// Feed nBits packed message bits into register reg. Less than a word inline on the
+// tables, longer messages dispatch at runtime to the carry-less multiply kernel when
+// the CPU has PCLMULQDQ / PMULL, else to the tables.
+inline uint32_t crcUpdate(const crcTable_s *tab, uint32_t reg, const uint64_t *words,
+                          int nBits) {
+    if (nBits < 64)
+        return nBits > 0 ? crcUpdateTail(tab, reg, words[0], nBits) : reg;
+    static const crcUpdate_f impl = crcHasClmul() ? crcUpdateClmul : crcUpdateTable;
+    return impl(tab, reg, words, nBits);
+}
+
+// CRC of L leading ones followed by msg, as L packed bits
+void crcAttach(const crcTable_s *tab, const bitvec_s *msg, bitvec_s *crc);
+
+#endif // CRC_H_
@@ -0,0 +1,600 @@
+#include "decdl.h"
+#include "arena.h"
+#include "bitvec.h"
+#include "crc.h"
+#include "pattern.h"
+#include "plan.h"
+#include "polar.h"
+#include "simd.h"
+#include "util.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include <xtensor/xarray.hpp>
+
+namespace fs = std::filesystem;
+
+#define DEC_N_LOG_MAX 10
+
+static_assert(DEC_L_MAX == SIMD_DEC_LANES, "one kernel lane per list path");
+
+// Build the pruned tree of the u segment [off, off + 2^k)
+static void decBuild(dec_s *dec, int k, int off) {
+    const plan_s *plan = dec->plan.get();
+    int m = 1 << k, nInfo = 0;
+    for (int i = off; i < off + m; ++i)
+        nInfo += bvGet(&plan->frozenMask, i);
+    bool firstInfo = bvGet(&plan->frozenMask, off);
+    bool lastInfo = bvGet(&plan->frozenMask, off + m - 1);
+    decOp_e op = DEC_F;
+    if (nInfo == 0)
+        op = DEC_RATE0;
+    else if (nInfo == m)
+        op = DEC_RATE1;
+    else if (nInfo == 1 && lastInfo)
+        op = DEC_REP;
+    else if (nInfo == m - 1 && !firstInfo)
+        op = DEC_SPC;
+    if (op != DEC_F) {
+        dec->prog.push_back({uint8_t(op), uint8_t(k), uint16_t(off)});
+        return;
+    }
+    dec->prog.push_back({DEC_F, uint8_t(k), uint16_t(off)});
+    decBuild(dec, k - 1, off);
+    dec->prog.push_back({DEC_G, uint8_t(k), uint16_t(off)});
+    decBuild(dec, k - 1, off + m / 2);
+    dec->prog.push_back({DEC_COMB, uint8_t(k), uint16_t(off)});
+}
+
+void decCreate(dec_s *dec, std::shared_ptr<const plan_s> plan) {
+    const params_s *p = &plan->params;
+    if (p->link != LINK_DL)
+        throw std::runtime_error("uplink decoding is not supported");
+    dec->plan = plan;
+    dec->pm = 0;
+    dec->n = 0;
+    while ((1 << dec->n) < p->N)
+        ++dec->n;
+    if ((1 << dec->n) != p->N || dec->n > DEC_N_LOG_MAX)
+        throw std::runtime_error("unsupported decoder size");
+
+    // Pruned tree
+    dec->prog.clear();
+    decBuild(dec, dec->n, 0);
+
+    // Encoded bits left out by shortening are known zeros
+    dec->shortIdx.clear();
+    if (patRmMode(p->K, p->E, p->N) == RM_SHORTENING) {
+        std::vector<uint8_t> sent(p->N, 0);
+        for (int e = 0; e < p->E; ++e)
+            sent[plan->rmIdx[e]] = 1;
+        for (int i = 0; i < p->N; ++i)
+            if (!sent[i])
+                dec->shortIdx.push_back(i);
+    }
+
+    // Stage k <= n holds 2^k LLRs of each path, the de-rate-matched channel LLRs follow
+    size_t size = size_t(DEC_L_MAX) * (2 * p->N - 1) + p->N;
+    dec->alpha16.assign(size, 0);
+    dec->alpha8.assign(size, 0);
+}
+
+template <class T> static inline T decSat(int x) {
+    const int vMax = std::numeric_limits<T>::max();
+    return T(std::min(std::max(x, -vMax), vMax));
+}
+
+static inline int decBit(const uint64_t *beta, int i) {
+    return (beta[i >> 6] >> (i & 63)) & 1;
+}
+
+static inline void decFlip(uint64_t *beta, int i) {
+    beta[i >> 6] ^= uint64_t{1} << (i & 63);
+}
+
+// Write m bits of x at bit offset off, off aligned to m
+static inline void decPut(uint64_t *beta, int off, int m, uint64_t x) {
+    if (m >= 64) {
+        beta[off >> 6] = x;
+        return;
+    }
+    uint64_t mask = ((uint64_t{1} << m) - 1) << (off & 63);
+    beta[off >> 6] = (beta[off >> 6] & ~mask) | ((x << (off & 63)) & mask);
+}
+
+// List state. Stage k holds the 2^k LLRs of every path interleaved, LLR i of path p at
+// i * DEC_L_MAX + p, so that f and g run over the whole list in the vector lanes of
+// the simd.h kernels. Forks copy no LLRs: path p reads lane lane[k][p] of stage k until
+// the next f or g rewrites the stage with every path in its own lane.
+template <class T> struct decList_s {
+    int L, n, N;
+    T *stage[DEC_N_LOG_MAX + 1];
+    bool active[DEC_L_MAX];
+    int32_t pm[DEC_L_MAX];
+    uint8_t lane[DEC_N_LOG_MAX + 1][DEC_L_MAX];
+    uint64_t beta[DEC_L_MAX][PLAN_N_MAX / 64];
+    uint16_t sel[DEC_L_MAX][DEC_L_MAX]; // Least reliable node positions
+    uint8_t gamma[DEC_L_MAX];           // SPC parity fix bit currently flipped
+
+    // LLR i of path p at stage k is rd(p, k)[i * DEC_L_MAX]
+    const T *rd(int p, int k) const { return stage[k] + lane[k][p]; }
+
+    void kill(int p) { active[p] = false; }
+
+    int clone(int p) {
+        int q = 0;
+        while (active[q])
+            ++q;
+        active[q] = true;
+        pm[q] = pm[p];
+        for (int k = 0; k < n; ++k)
+            lane[k][q] = lane[k][p];
+        std::memcpy(beta[q], beta[p], sizeof(uint64_t) * ((N + 63) >> 6));
+        std::memcpy(sel[q], sel[p], sizeof(sel[p]));
+        gamma[q] = gamma[p];
+        return q;
+    }
+
+    // One list expansion: path p continues with cost[p][0] or forks with cost[p][1],
+    // the L best survive and apply(p) commits the forked choice
+    template <class F> void step(const int32_t (*cost)[2], F apply) {
+        // Candidate 2p + c ranked by metric, then index, on distinct metric << 4 | 2p + c
+        // keys; the metric above the best path, costs are not negative, saturates where
+        // the key would overflow. The ranks of all candidates go up together over the
+        // full list width, which the compiler vectorizes.
+        int32_t base = std::numeric_limits<int32_t>::max();
+        for (int p = 0; p < L; ++p)
+            if (active[p])
+                base = std::min(base, pm[p]);
+        int32_t key[2 * DEC_L_MAX], rank[2 * DEC_L_MAX] = {};
+        for (int p = 0; p < DEC_L_MAX; ++p)
+            for (int c = 0; c < 2; ++c) {
+                int32_t d = p < L && active[p] ? std::min(pm[p] + cost[p][c] - base,
+                                                          (int32_t{1} << 26) - 1)
+                                               : int32_t{1} << 26;
+                key[2 * p + c] = d << 4 | (2 * p + c);
+            }
+        for (int j = 0; j < 2 * DEC_L_MAX; ++j)
+            for (int i = 0; i < 2 * DEC_L_MAX; ++i)
+                rank[i] += key[j] < key[i];
+        bool keep[DEC_L_MAX][2];
+        for (int i = 0; i < 2 * L; ++i)
+            keep[i >> 1][i & 1] = rank[i] < L && active[i >> 1];
+
+        // Prune first so the forks find free slots
+        bool was[DEC_L_MAX];
+        for (int p = 0; p < L; ++p) {
+            was[p] = active[p];
+            if (active[p] && !keep[p][0] && !keep[p][1])
+                kill(p);
+        }
+        for (int p = 0; p < L; ++p) {
+            if (!was[p] || !active[p])
+                continue;
+            int32_t pm0 = pm[p] + cost[p][0], pm1 = pm[p] + cost[p][1];
+            if (keep[p][0] && keep[p][1]) {
+                int q = clone(p);
+                was[q] = false; // Slot may have been pruned above
+                pm[q] = pm1;
+                apply(q);
+                pm[p] = pm0;
+            } else if (keep[p][0]) {
+                pm[p] = pm0;
+            } else {
+                pm[p] = pm1;
+                apply(p);
+            }
+        }
+    }
+};
+
+// Bit p of bits[i] = beta bit off + i of path p for i < h and p < L, 0 for the unused
+// paths: 8 x 8 bit transposes of one byte of each path
+static void decLaneBits(const uint64_t (*beta)[PLAN_N_MAX / 64], int L, int off, int h,
+                        uint8_t *bits) {
+    if (L == 1) {
+        for (int i = 0; i < h; ++i)
+            bits[i] = decBit(beta[0], off + i);
+        return;
+    }
+    for (int i = 0; i < h; i += 8) {
+        int j = off + i;
+        uint64_t x = 0;
+        for (int p = 0; p < L; ++p)
+            x |= ((beta[p][j >> 6] >> (j & 63)) & 0xff) << (8 * p);
+        uint64_t t = (x ^ (x >> 7)) & 0x00aa00aa00aa00aaull;
+        x ^= t ^ (t << 7);
+        t = (x ^ (x >> 14)) & 0x0000cccc0000ccccull;
+        x ^= t ^ (t << 14);
+        t = (x ^ (x >> 28)) & 0x00000000f0f0f0f0ull;
+        x ^= t ^ (t << 28);
+        for (int b = 0; b < std::min(h - i, 8); ++b)
+            bits[i + b] = uint8_t(x >> (8 * b));
+    }
+}
+
+// Hard decisions of m LLRs a[i * DEC_L_MAX] into beta at off
+template <class T> static void decHard(const T *a, int m, uint64_t *beta, int off) {
+    for (int i = 0; i < m; i += 64) {
+        uint64_t x = 0;
+        for (int j = 0; j < std::min(m - i, 64); ++j)
+            x |= uint64_t(a[(i + j) * DEC_L_MAX] < 0) << j;
+        decPut(beta, off + i, m, x);
+    }
+}
+
+// The t least reliable of m LLRs a[i * DEC_L_MAX], most unreliable first. Sorted on
+// |LLR| << 16 | i keys so that ties keep the lower position first.
+template <class T> static void decLeast(const T *a, int m, int t, uint16_t *sel) {
+    uint32_t key[DEC_L_MAX];
+    int nSel = 0;
+    for (int i = 0; i < m; ++i) {
+        uint32_t v = uint32_t(std::abs(int(a[i * DEC_L_MAX]))) << 16 | uint32_t(i);
+        if (nSel == t && v >= key[t - 1])
+            continue;
+        int j = std::min(nSel, t - 1);
+        while (j > 0 && key[j - 1] > v) {
+            key[j] = key[j - 1];
+            --j;
+        }
+        key[j] = v;
+        nSel = std::min(nSel + 1, t);
+    }
+    for (int j = 0; j < t; ++j)
+        sel[j] = uint16_t(key[j]);
+}
+
+// Comparators of Batcher's odd-even merge sort of 2^k keys, k <= DEC_NET_LOG_MAX
+#define DEC_NET_LOG_MAX 5
+
+typedef struct decNet_s {
+    int n;
+    uint8_t lo[192], hi[192];
+} decNet_s;
+
+static const decNet_s *decNet(int k) {
+    static const std::vector<decNet_s> nets = [] {
+        std::vector<decNet_s> v(DEC_NET_LOG_MAX + 1);
+        for (int k = 0; k <= DEC_NET_LOG_MAX; ++k) {
+            decNet_s *net = &v[k];
+            const int m = 1 << k;
+            net->n = 0;
+            for (int q = 1; q < m; q <<= 1)
+                for (int r = q; r >= 1; r >>= 1)
+                    for (int j = r % q; j + r < m; j += 2 * r)
+                        for (int i = j; i < j + std::min(r, m - j - r); ++i)
+                            if (i / (2 * q) == (i + r) / (2 * q)) {
+                                net->lo[net->n] = uint8_t(i);
+                                net->hi[net->n++] = uint8_t(i + r);
+                            }
+        }
+        return v;
+    }();
+    return &nets[k];
+}
+
+// decLeast of every path at once for nodes of size 2^k, k <= DEC_NET_LOG_MAX, path p
+// reading lane lane[p]. The keys of all paths go through the sorting network side by
+// side in the vector lanes; a single position is a minimum.
+template <class T>
+static void decLeastList(const simdKernels_s *simd, const T *a, const uint8_t *lane,
+                         int k, int t, uint16_t (*sel)[DEC_L_MAX]) {
+    const int m = 1 << k;
+    uint32_t key[1 << DEC_NET_LOG_MAX][DEC_L_MAX];
+    for (int i = 0; i < m; ++i)
+        for (int p = 0; p < DEC_L_MAX; ++p)
+            key[i][p] = uint32_t(std::abs(int(a[i * DEC_L_MAX + lane[p]]))) << 16 | i;
+    if (t == 1) {
+        for (int i = 1; i < m; ++i)
+            for (int p = 0; p < DEC_L_MAX; ++p)
+                key[0][p] = std::min(key[0][p], key[i][p]);
+    } else {
+        const decNet_s *net = decNet(k);
+        simd->decSort(key[0], net->lo, net->hi, net->n);
+    }
+    for (int p = 0; p < DEC_L_MAX; ++p)
+        for (int j = 0; j < t; ++j)
+            sel[p][j] = uint16_t(key[j][p]);
+}
+
+// The f and g kernels of the LLR type
+static inline void decKernelF(const simdKernels_s *k, const int16_t *a, int h,
+                              const uint8_t *lane, int16_t *c) {
+    k->decF16(a, h, lane, c);
+}
+
+static inline void decKernelF(const simdKernels_s *k, const int8_t *a, int h,
+                              const uint8_t *lane, int8_t *c) {
+    k->decF8(a, h, lane, c);
+}
+
+static inline void decKernelG(const simdKernels_s *k, const int16_t *a,
+                              const uint8_t *bits, int h, const uint8_t *lane,
+                              int16_t *c) {
+    k->decG16(a, bits, h, lane, c);
+}
+
+static inline void decKernelG(const simdKernels_s *k, const int8_t *a,
+                              const uint8_t *bits, int h, const uint8_t *lane,
+                              int8_t *c) {
+    k->decG8(a, bits, h, lane, c);
+}
+
+// De-rate-matching: repetitions add up, punctured bits stay 0, shortened ones are
+// known zeros
+template <class T> static void decDerm(const dec_s *dec, const T *llr, T *ch) {
+    const plan_s *plan = dec->plan.get();
+    std::fill(ch, ch + plan->params.N, T(0));
+    for (int e = 0; e < plan->params.E; ++e)
+        ch[plan->rmIdx[e]] = decSat<T>(ch[plan->rmIdx[e]] + llr[e]);
+    for (uint16_t i : dec->shortIdx)
+        ch[i] = std::numeric_limits<T>::max();
+}
+
+// Decode E rate matched LLRs, or N channel LLRs when derm is already done
+template <class T>
+static bool decRun(dec_s *dec, T *alpha, const T *llr, bool derm, int L, uint16_t rnti,
+                   uint64_t *info) {
+    const plan_s *plan = dec->plan.get();
+    const params_s *pp = &plan->params;
+    const int N = pp->N, n = dec->n;
+    const simdKernels_s *simd = simdGet();
+    if (L < 1 || L > DEC_L_MAX)
+        throw std::runtime_error("unsupported list size");
+
+    static const uint8_t identity[DEC_L_MAX] = {0, 1, 2, 3, 4, 5, 6, 7};
+    decList_s<T> s;
+    s.L = L;
+    s.n = n;
+    s.N = N;
+    for (int k = 0; k <= n; ++k) {
+        s.stage[k] = alpha + size_t(DEC_L_MAX) * ((1 << k) - 1);
+        std::memcpy(s.lane[k], identity, DEC_L_MAX);
+    }
+    for (int p = 0; p < DEC_L_MAX; ++p)
+        s.active[p] = false;
+    s.active[0] = true;
+    s.pm[0] = 0;
+    std::memset(s.beta, 0, sizeof(s.beta));
+
+    // Channel LLRs in lane 0 of stage n, read by every path
+    T *ch = alpha + size_t(DEC_L_MAX) * (2 * N - 1);
+    if (derm)
+        std::copy(llr, llr + N, ch);
+    else
+        decDerm(dec, llr, ch);
+    for (int i = 0; i < N; ++i)
+        s.stage[n][i * DEC_L_MAX] = ch[i];
+    std::memset(s.lane[n], 0, DEC_L_MAX);
+
+    int32_t cost[DEC_L_MAX][2];
+    uint8_t bits[PLAN_N_MAX / 2];
+    for (const decInstr_s &ins : dec->prog) {
+        const int k = ins.k, m = 1 << k, h = m / 2, off = ins.off;
+        switch (ins.op) {
+        case DEC_F:
+            decKernelF(simd, s.stage[k], h, s.lane[k], s.stage[k - 1]);
+            std::memcpy(s.lane[k - 1], identity, DEC_L_MAX);
+            break;
+        case DEC_G:
+            decLaneBits(s.beta, L, off, h, bits);
+            decKernelG(simd, s.stage[k], bits, h, s.lane[k], s.stage[k - 1]);
+            std::memcpy(s.lane[k - 1], identity, DEC_L_MAX);
+            break;
+        case DEC_COMB:
+            for (int p = 0; p < L; ++p) {
+                if (!s.active[p])
+                    continue;
+                uint64_t *b = s.beta[p];
+                if (h >= 64) {
+                    for (int w = 0; w < h / 64; ++w)
+                        b[(off >> 6) + w] ^= b[((off + h) >> 6) + w];
+                } else {
+                    uint64_t x = b[off >> 6] >> (off & 63);
+                    decPut(b, off, h, x ^ (x >> h));
+                }
+            }
+            break;
+        case DEC_RATE0:
+            for (int p = 0; p < L; ++p) {
+                if (!s.active[p])
+                    continue;
+                const T *a = s.rd(p, k);
+                for (int i = 0; i < m; ++i)
+                    s.pm[p] += std::max(-int(a[i * DEC_L_MAX]), 0);
+                for (int i = 0; i < m; i += 64)
+                    decPut(s.beta[p], off + i, m, 0);
+            }
+            break;
+        case DEC_RATE1: {
+            int t = std::min(L - 1, m);
+            if (t > 0 && k <= DEC_NET_LOG_MAX)
+                decLeastList(simd, s.stage[k], s.lane[k], k, t, s.sel);
+            for (int p = 0; p < L; ++p) {
+                if (!s.active[p])
+                    continue;
+                const T *a = s.rd(p, k);
+                decHard(a, m, s.beta[p], off);
+                if (t > 0 && k > DEC_NET_LOG_MAX)
+                    decLeast(a, m, t, s.sel[p]);
+            }
+            for (int j = 0; j < t; ++j) {
+                for (int p = 0; p < L; ++p)
+                    if (s.active[p]) {
+                        cost[p][0] = 0;
+                        cost[p][1] = std::abs(s.rd(p, k)[s.sel[p][j] * DEC_L_MAX]);
+                    }
+                s.step(cost, [&](int p) { decFlip(s.beta[p], off + s.sel[p][j]); });
+            }
+            break;
+        }
+        case DEC_REP:
+            for (int p = 0; p < L; ++p) {
+                if (!s.active[p])
+                    continue;
+                const T *a = s.rd(p, k);
+                cost[p][0] = cost[p][1] = 0;
+                for (int i = 0; i < m; ++i)
+                    cost[p][a[i * DEC_L_MAX] >= 0] += std::abs(a[i * DEC_L_MAX]);
+                for (int i = 0; i < m; i += 64)
+                    decPut(s.beta[p], off + i, m, 0);
+            }
+            s.step(cost, [&](int p) {
+                for (int i = 0; i < m; i += 64)
+                    decPut(s.beta[p], off + i, m, ~uint64_t{0});
+            });
+            break;
+        case DEC_SPC: {
+            int t = std::min(L, m);
+            bool list = L > 1 && k <= DEC_NET_LOG_MAX;
+            if (list)
+                decLeastList(simd, s.stage[k], s.lane[k], k, t, s.sel);
+            for (int p = 0; p < L; ++p) {
+                if (!s.active[p])
+                    continue;
+                const T *a = s.rd(p, k);
+                decHard(a, m, s.beta[p], off);
+                if (!list)
+                    decLeast(a, m, t, s.sel[p]);
+                int parity = 0;
+                for (int i = 0; i < m; ++i)
+                    parity ^= a[i * DEC_L_MAX] < 0;
+                s.gamma[p] = parity;
+                if (parity) {
+                    decFlip(s.beta[p], off + s.sel[p][0]);
+                    s.pm[p] += std::abs(a[s.sel[p][0] * DEC_L_MAX]);
+                }
+            }
+            for (int j = 1; j < t; ++j) {
+                for (int p = 0; p < L; ++p)
+                    if (s.active[p]) {
+                        const T *a = s.rd(p, k);
+                        int aMin = std::abs(a[s.sel[p][0] * DEC_L_MAX]);
+                        cost[p][0] = 0;
+                        cost[p][1] = std::abs(a[s.sel[p][j] * DEC_L_MAX]) +
+                                     (s.gamma[p] ? -aMin : aMin);
+                    }
+                s.step(cost, [&](int p) {
+                    decFlip(s.beta[p], off + s.sel[p][j]);
+                    decFlip(s.beta[p], off + s.sel[p][0]);
+                    s.gamma[p] ^= 1;
+                });
+            }
+            break;
+        }
+        }
+    }
+
+    // Paths by metric, the first one passing the CRC wins
+    int order[DEC_L_MAX], nPath = 0;
+    for (int p = 0; p < L; ++p) {
+        if (!s.active[p])
+            continue;
+        int j = nPath++;
+        while (j > 0 && s.pm[order[j - 1]] > s.pm[p]) {
+            order[j] = order[j - 1];
+            --j;
+        }
+        order[j] = p;
+    }
+    const int A = pp->A, P = pp->P, K = pp->K;
+    const uint32_t crcMask = (uint32_t{1} << P) - 1;
+    const uint32_t rntiMask = planRntiMask(plan, rnti);
+    for (int i = 0; i < nPath; ++i) {
+        // Re-encoding the codeword gives u, the transform is its own inverse
+        uint64_t u[PLAN_N_MAX / 64];
+        std::memcpy(u, s.beta[order[i]], sizeof(uint64_t) * ((N + 63) >> 6));
+        polarEncPacked(u, N);
+        uint64_t c[PLAN_K_MAX / 64 + 1] = {};
+        for (int j = 0; j < K; ++j)
+            if (decBit(u, plan->infoPos[j]))
+                decFlip(c, plan->crcIntrl[j]);
+
+        uint32_t crc = crcUpdate(plan->crc, plan->crc->onesInit, c, A) ^ rntiMask;
+        uint64_t rx = c[A >> 6] >> (A & 63);
+        if ((A & 63) + P > 64)
+            rx |= c[(A >> 6) + 1] << (64 - (A & 63));
+        bool ok = (uint32_t(rx) & crcMask) == crc;
+        if (ok || i == 0) {
+            dec->pm = s.pm[order[i]];
+            for (int w = 0; w < bvWords(A); ++w)
+                info[w] = c[w];
+            if (A & 63)
+                info[bvWords(A) - 1] &= (uint64_t{1} << (A & 63)) - 1;
+        }
+        if (ok)
+            return true;
+    }
+    return false;
+}
+
+bool decDecode16(dec_s *dec, const int16_t *llr, int L, uint16_t rnti, uint64_t *info) {
+    return decRun<int16_t>(dec, dec->alpha16.data(), llr, false, L, rnti, info);
+}
+
+bool decDecode8(dec_s *dec, const int8_t *llr, int L, uint16_t rnti, uint64_t *info) {
+    return decRun<int8_t>(dec, dec->alpha8.data(), llr, false, L, rnti, info);
+}
+
+void decDerm16(const dec_s *dec, const int16_t *llr, int16_t *ch) {
+    decDerm<int16_t>(dec, llr, ch);
+}
+
+bool decDecodeCh16(dec_s *dec, const int16_t *ch, int L, uint16_t rnti, uint64_t *info) {
+    return decRun<int16_t>(dec, dec->alpha16.data(), ch, true, L, rnti, info);
+}
+
+void decDl(fs::path path, const polarCfg_s *cfg, int L) {
+    const params_s *params = &cfg->params;
+    const int nIter = 1000;
+
+    // Decoder on the cached plan
+    dec_s dec;
+    decCreate(&dec, planGet(planCacheDefault(), cfg));
+
+    // Read info and RNTI bits, RNTI MSB first
+    bitvec_s infoBits, rmBits;
+    readPacked(path / "info_bits.txt", params->A, &infoBits);
+    uint16_t rnti = readRnti(path / "rnti_bits.txt");
+
+    // Noiseless BPSK LLRs of the rate matched bits
+    readPacked(path / "rm_bits.txt", params->E, &rmBits);
+    std::vector<int16_t> llr16(params->E);
+    std::vector<int8_t> llr8(params->E);
+    for (int e = 0; e < params->E; ++e) {
+        llr16[e] = bvGet(&rmBits, e) ? -256 : 256;
+        llr8[e] = bvGet(&rmBits, e) ? -16 : 16;
+    }
+
+    // Both precisions, compared with the info bits and timed
+    bitvec_s infoDec;
+    bvInit(&infoDec, params->A);
+    for (int bits : {16, 8}) {
+        bool ok = false;
+        int64_t nAllocs = allocCount();
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < nIter; ++i)
+            ok = bits == 16
+                     ? decDecode16(&dec, llr16.data(), L, rnti, infoDec.words.data())
+                     : decDecode8(&dec, llr8.data(), L, rnti, infoDec.words.data());
+        auto t1 = std::chrono::steady_clock::now();
+        int nDiffInfo = 0;
+        for (int a = 0; a < params->A; ++a)
+            nDiffInfo += bvGet(&infoDec, a) != bvGet(&infoBits, a);
+        std::cout << "decode int" << bits << " L=" << L << ": crcOk " << ok
+                  << ", nDiffInfo " << nDiffInfo << ", "
+                  << std::chrono::duration<double, std::nano>(t1 - t0).count() / nIter
+                  << " ns" << std::endl;
+        if (nAllocs >= 0)
+            std::cout << "nAllocs per codeword: "
+                      << (allocCount() - nAllocs) / double(nIter) << std::endl;
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef DECDL_H_
+#define DECDL_H_
+
+#include "encdl.h"
+#include "plan.h"
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Largest list size
+#define DEC_L_MAX 8
+
+// Decoder program: f/g LLR updates, partial sum combines and the special nodes of
+// the pruned decoding tree (Fast-SSC), each on the node of size 2^k at u offset off
+typedef enum decOp_e {
+    DEC_F,
+    DEC_G,
+    DEC_COMB,
+    DEC_RATE0, // All frozen, x = 0
+    DEC_RATE1, // All info, x = hard decisions
+    DEC_REP,   // Last bit info, x = all zeros or all ones
+    DEC_SPC,   // First bit frozen, x = even parity word
+} decOp_e;
+
+typedef struct decInstr_s {
+    uint8_t op;
+    uint8_t k;
+    uint16_t off;
+} decInstr_s;
+
+// Decoder of one plan. The scratch buffers make it single threaded, use one decoder
+// per thread.
+typedef struct dec_s {
+    std::shared_ptr<const plan_s> plan;
+    int n;                           // log2(N)
+    std::vector<decInstr_s> prog;    // Pruned tree in decoding order
+    std::vector<uint16_t> shortIdx;  // Shortened encoded bits, known zeros
+    std::vector<int16_t> alpha16;    // LLR buffers, DEC_L_MAX per stage + channel
+    std::vector<int8_t> alpha8;
+    int32_t pm; // Path metric of the path returned by the last decoding
+} dec_s;
+
+void decCreate(dec_s *dec, std::shared_ptr<const plan_s> plan);
+
+// CA-SCL decoding of E rate matched LLRs (positive for bit 0) with list size L of
+// 1, 2, 4 or 8, L = 1 is plain SC. Writes bvWords(A) packed info words of the most
+// likely path passing the RNTI scrambled CRC, or of the most likely path when none
+// passes, and returns whether the CRC passed.
+bool decDecode16(dec_s *dec, const int16_t *llr, int L, uint16_t rnti, uint64_t *info);
+bool decDecode8(dec_s *dec, const int8_t *llr, int L, uint16_t rnti, uint64_t *info);
+
+// De-rate-matching of E LLRs into the N channel LLRs of the decoder. Decoders of plans
+// with the same rate matching (rmIdx and shortened bits) share the result.
+void decDerm16(const dec_s *dec, const int16_t *llr, int16_t *ch);
+
+// decDecode16 of N channel LLRs from decDerm16
+bool decDecodeCh16(dec_s *dec, const int16_t *ch, int L, uint16_t rnti, uint64_t *info);
+
+// Decode the rate matched bits of a test vector and compare with its info bits
+void decDl(fs::path path, const polarCfg_s *cfg, int L = DEC_L_MAX);
+
+#endif // DECDL_H_
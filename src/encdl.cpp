@@ -1,12 +1,24 @@
 #include "encdl.h"
+#include "arena.h"
+#include "batch.h"
+#include "bitvec.h"
+#include "crc.h"
+#include "pattern.h"
+#include "plan.h"
+#include "polar.h"
+#include "prof.h"
+#include "ratematch.h"
+#include "trace.h"
+#include "util.h"
+#include <algorithm>
 #include <filesystem>
-#include <fstream>
 #include <iostream>
-#include <istream>
+#include <memory>
+#include <vector>
 #include <xtensor-blas/xlinalg.hpp>
+#include <xtensor/xadapt.hpp>
 #include <xtensor/xarray.hpp>
 #include <xtensor/xbuilder.hpp>
-#include <xtensor/xcsv.hpp>
 #include <xtensor/xindex_view.hpp>
 #include <xtensor/xio.hpp>
 #include <xtensor/xmanipulation.hpp>
@@ -15,120 +27,284 @@
 
 namespace fs = std::filesystem;
 
-void encDl(fs::path path, params_s *params) {
+static xt::xarray<int> unpackBits(const bitvec_s *bv) {
+    xt::xarray<int> bits = xt::zeros<int>({bv->nBits});
+    bvUnpack(bv, bits.data());
+    return bits;
+}
 
-    // Input file
-    std::ifstream in_file;
+static xt::xarray<int> encDlPacked(fs::path path, const polarCfg_s *cfg) {
+    const params_s *params = &cfg->params;
+
+    // Cached encoder plan
+    std::shared_ptr<const plan_s> plan = planGet(planCacheDefault(), cfg);
+
+    // Read info bits
+    bitvec_s infoBits;
+    readPacked(path / "info_bits.txt", params->A, &infoBits);
+
+    // Read RNTI bits, MSB first
+    uint16_t rnti = readRnti(path / "rnti_bits.txt");
+
+    // Encoding with the plan, no file I/O or allocation
+    bitvec_s rmBits;
+    bvInit(&rmBits, params->E);
+    planEncode(plan.get(), infoBits.words.data(), rnti, rmBits.words.data());
+
+    // Steady state must not allocate
+    int64_t nAllocs = allocCount();
+    for (int i = 0; i < 1000; ++i) {
+        profTimer_s timer(PROF_ENCODE);
+        planEncode(plan.get(), infoBits.words.data(), rnti, rmBits.words.data());
+    }
+    if (nAllocs >= 0)
+        std::cout << "nAllocs per codeword: " << (allocCount() - nAllocs) / 1000.0
+                  << std::endl;
+    XT_TRACE(TRACE_DEBUG, TRACE_RM,
+             "rmBits (packed words):" << std::endl << xt::adapt(rmBits.words));
+    return unpackBits(&rmBits);
+}
+
+static xt::xarray<int> encDlBatch(fs::path path, const polarCfg_s *cfg) {
+    const params_s *params = &cfg->params;
+    const int B = 100;
+
+    // Cached encoder plan
+    std::shared_ptr<const plan_s> plan = planGet(planCacheDefault(), cfg);
+
+    // Read info bits and replicate into B rows
+    bitvec_s infoBits;
+    readPacked(path / "info_bits.txt", params->A, &infoBits);
+    int nInfoWords = infoBits.words.size();
+    std::vector<uint64_t> info(B * nInfoWords);
+    for (int b = 0; b < B; ++b)
+        std::copy(infoBits.words.begin(), infoBits.words.end(), &info[b * nInfoWords]);
+
+    // Read RNTI bits, MSB first
+    std::vector<uint16_t> rnti(B, readRnti(path / "rnti_bits.txt"));
+
+    // Batched bit-sliced encoding
+    int nRmWords = bvWords(params->E);
+    std::vector<uint64_t> rm(B * nRmWords);
+    batchEncode(plan.get(), B, info.data(), rnti.data(), rm.data());
+
+    // Steady state must not allocate
+    int64_t nAllocs = allocCount();
+    for (int i = 0; i < 10; ++i)
+        batchEncode(plan.get(), B, info.data(), rnti.data(), rm.data());
+    if (nAllocs >= 0)
+        std::cout << "nAllocs per codeword: " << (allocCount() - nAllocs) / (10.0 * B)
+                  << std::endl;
+
+    // All rows must be equal
+    int nDiffRows = 0;
+    for (int b = 1; b < B; ++b)
+        nDiffRows += !std::equal(&rm[0], &rm[nRmWords], &rm[b * nRmWords]);
+    std::cout << "nDiffRows: " << nDiffRows << std::endl;
+
+    bitvec_s rmBits;
+    bvInit(&rmBits, params->E);
+    std::copy(&rm[(B - 1) * nRmWords], &rm[B * nRmWords], rmBits.words.begin());
+    return unpackBits(&rmBits);
+}
+
+static void checkRmBits(fs::path path, const xt::xarray<int> &rmBits) {
+
+    // Read rate matched reference bits
+    xt::xarray<int> rmRefs = readBits(path / "rm_bits.txt");
+    XT_TRACE(TRACE_DEBUG, TRACE_RM,
+             xt::print_options::line_width(160) << "rmRefs:" << std::endl
+                                                << xt::transpose(rmRefs));
+
+    // Check results
+    xt::xarray<int> checkBits = xt::abs(rmRefs - rmBits);
+    int nDiffBits = xt::sum(checkBits)();
+    std::cout << "nDiffBits: " << nDiffBits << std::endl;
+}
+
+static void checkPatterns(fs::path path, const params_s *params) {
+
+    // Generated patterns against the test vector files
+    std::vector<uint16_t> crcIntrl(params->K);
+    patCrcIntrl(params->K, crcIntrl.data());
+    xt::xarray<int> crcIntrlRef = readBits(path / "crc_interleaver_pattern.txt");
+    int nDiffCrcIntrl = xt::sum(xt::not_equal(crcIntrlRef, xt::adapt(crcIntrl)))();
+
+    std::vector<uint8_t> infoIntrl(params->N);
+    patInfoBits(params->K, params->E, params->N, infoIntrl.data());
+    xt::xarray<int> infoIntrlRef = readBits(path / "info_bit_pattern.txt");
+    int nDiffInfoIntrl = xt::sum(xt::not_equal(infoIntrlRef, xt::adapt(infoIntrl)))();
+
+    std::vector<uint16_t> encIntrl(params->E);
+    patRateMatch(params->K, params->E, params->N, encIntrl.data());
+    xt::xarray<int> encIntrlRef = readBits(path / "rate_matching_pattern.txt");
+    int nDiffEncIntrl = xt::sum(xt::not_equal(encIntrlRef, xt::adapt(encIntrl)))();
+
+    std::cout << "nDiffPatterns: crcIntrl " << nDiffCrcIntrl << ", infoIntrl "
+              << nDiffInfoIntrl << ", encIntrl " << nDiffEncIntrl << std::endl;
+}
+
+void encDl(fs::path path, const polarCfg_s *cfg, encMode_e mode) {
+    const params_s *params = &cfg->params;
+
+    // Packed bit chain, the only one for the uplink
+    if (params->link == LINK_UL) {
+        checkRmBits(path, encDlPacked(path, cfg));
+        return;
+    }
+    if (mode == ENC_PACKED || mode == ENC_BATCH) {
+        checkRmBits(path, mode == ENC_PACKED ? encDlPacked(path, cfg)
+                                             : encDlBatch(path, cfg));
+        checkPatterns(path, params);
+        return;
+    }
+
+    // Scratch spans of the intermediate arrays
+    arena_s *arena = arenaThread();
+    arenaReserve(arena, arenaBytes(params));
+    size_t mark = arenaMark(arena);
 
     // Read info bits
-    fs::path infoBitsPath = path / "info_bits.txt";
-    in_file.open(infoBitsPath);
-    xt::xarray<int> infoBits = xt::ravel(xt::load_csv<int>(in_file));
-    std::cout << "infoBits:" << std::endl << xt::transpose(infoBits) << std::endl;
-    in_file.close();
-
-    // Read CRC matrix
-    fs::path crcGenVecPath = path / "crc_gen_m.txt";
-    in_file.open(crcGenVecPath);
-    xt::xarray<int> crcGenVec = xt::ravel(xt::load_csv<short>(in_file));
-    xt::xarray<int> crcGenMtx = xt::transpose(crcGenVec.reshape({params->P, params->K}));
-    std::cout << "crcGenMtx:" << std::endl
-              << xt::print_options::line_width(160) << xt::print_options::edge_items(20)
-              << crcGenMtx << std::endl;
-    in_file.close();
+    xt::xarray<int> infoBits = readBits(path / "info_bits.txt");
+    XT_TRACE(TRACE_DEBUG, TRACE_INFO_BITS,
+             "infoBits:" << std::endl << xt::transpose(infoBits));
 
     // CRC computation
-    xt::xarray<int> crcBits = xt::linalg::dot(
-        xt::concatenate(xt::xtuple(xt::ones<int>({params->P}), infoBits)), crcGenMtx);
-    crcBits %= 2;
-    std::cout << "crcBits:" << std::endl << xt::transpose(crcBits) << std::endl;
+    auto crcBits = arenaAdapt<int>(arena, params->P);
+    if (mode == ENC_GEMM) {
+        // Read CRC matrix
+        fs::path crcGenVecPath = path / "crc_gen_m.txt";
+        xt::xarray<int> crcGenVec = readBits(crcGenVecPath);
+        xt::xarray<int> crcGenMtx =
+            xt::transpose(crcGenVec.reshape({params->P, params->K}));
+        XT_TRACE(TRACE_DEBUG, TRACE_MTX,
+                 "crcGenMtx:" << std::endl << xt::print_options::line_width(160)
+                              << xt::print_options::edge_items(20) << crcGenMtx);
+
+        // Reference CRC with generator matrix
+        profTimer_s timer(PROF_CRC);
+        crcBits = xt::linalg::dot(
+            xt::concatenate(xt::xtuple(xt::ones<int>({params->P}), infoBits)),
+            crcGenMtx);
+        crcBits %= 2;
+    } else {
+        // Table driven CRC
+        profTimer_s timer(PROF_CRC);
+        bitvec_s infoPacked, crcPacked;
+        bvPack(&infoPacked, infoBits.data(), params->A);
+        crcAttach(crcSelect(params->P), &infoPacked, &crcPacked);
+        bvUnpack(&crcPacked, crcBits.data());
+    }
+    XT_TRACE(TRACE_DEBUG, TRACE_CRC, "crcBits:" << std::endl << xt::transpose(crcBits));
 
     // Read RNTI bits
-    fs::path rntiBitsPath = path / "rnti_bits.txt";
-    in_file.open(rntiBitsPath);
-    xt::xarray<int> rntiBits = xt::ravel(xt::load_csv<int>(in_file));
-    std::cout << "rntiBits:" << std::endl << xt::transpose(rntiBits) << std::endl;
-    in_file.close();
+    xt::xarray<int> rntiBits = readBits(path / "rnti_bits.txt");
+    XT_TRACE(TRACE_DEBUG, TRACE_SCRAMBLE,
+             "rntiBits:" << std::endl << xt::transpose(rntiBits));
 
     // CRC scramble
-    xt::xarray<int> scrBits =
-        crcBits ^ xt::concatenate(xt::xtuple(
-                      xt::zeros<int>({params->P - rntiBits.size()}), rntiBits));
-    std::cout << "scrBits:" << std::endl << xt::transpose(scrBits) << std::endl;
+    profTimer_s scrTimer(PROF_SCRAMBLE);
+    auto scrBits = arenaAdapt<int>(arena, params->P);
+    scrBits = crcBits ^ xt::concatenate(xt::xtuple(
+                            xt::zeros<int>({params->P - rntiBits.size()}), rntiBits));
+    XT_TRACE(TRACE_DEBUG, TRACE_SCRAMBLE,
+             "scrBits:" << std::endl << xt::transpose(scrBits));
 
     // CRC attachment
-    xt::xarray<int> infoCrcBits = xt::concatenate(xt::xtuple(infoBits, scrBits));
-    std::cout << xt::print_options::line_width(160) << "infoCrcBits:" << std::endl
-              << xt::transpose(infoCrcBits) << std::endl;
-
-    // Read CRC interleaver pattern
-    fs::path ctrlIntrlPath = path / "crc_interleaver_pattern.txt";
-    in_file.open(ctrlIntrlPath);
-    xt::xarray<int> crcIntrl = xt::ravel(xt::load_csv<int>(in_file));
-    std::cout << xt::print_options::line_width(160) << "crcIntrl:" << std::endl
-              << xt::transpose(crcIntrl) << std::endl;
-    in_file.close();
+    auto infoCrcBits = arenaAdapt<int>(arena, params->K);
+    infoCrcBits = xt::concatenate(xt::xtuple(infoBits, scrBits));
+    scrTimer.stop();
+    XT_TRACE(TRACE_DEBUG, TRACE_CRC,
+             xt::print_options::line_width(160) << "infoCrcBits:" << std::endl
+                                                << xt::transpose(infoCrcBits));
+
+    // CRC interleaver pattern, read for the reference
+    std::vector<uint16_t> crcIntrlGen(params->K);
+    patCrcIntrl(params->K, crcIntrlGen.data());
+    xt::xarray<int> crcIntrl = xt::adapt(crcIntrlGen);
+    if (mode == ENC_GEMM)
+        crcIntrl = readBits(path / "crc_interleaver_pattern.txt");
+    XT_TRACE(TRACE_DEBUG, TRACE_INTRL,
+             xt::print_options::line_width(160) << "crcIntrl:" << std::endl
+                                                << xt::transpose(crcIntrl));
 
     // CRC interleaver
-    xt::xarray<int> intrlBits = xt::zeros_like(infoCrcBits);
+    profTimer_s intrlTimer(PROF_INTRL);
+    auto intrlBits = arenaAdapt<int>(arena, params->K);
     intrlBits = xt::index_view(infoCrcBits, crcIntrl);
-    std::cout << xt::print_options::line_width(160) << "intrlBits:" << std::endl
-              << xt::transpose(intrlBits) << std::endl;
+    intrlTimer.stop();
+    XT_TRACE(TRACE_DEBUG, TRACE_INTRL,
+             xt::print_options::line_width(160) << "intrlBits:" << std::endl
+                                                << xt::transpose(intrlBits));
 
-    // Read CRC interleaver pattern
-    fs::path infoIntrlPath = path / "info_bit_pattern.txt";
-    in_file.open(infoIntrlPath);
-    xt::xarray<int> infoIntrl = xt::ravel(xt::load_csv<int>(in_file));
-    std::cout << xt::print_options::line_width(160) << "infoIntrl:" << std::endl
-              << xt::transpose(infoIntrl) << std::endl;
-    in_file.close();
+    // Info bit pattern, read for the reference
+    std::vector<uint8_t> infoIntrlGen(params->N);
+    patInfoBits(params->K, params->E, params->N, infoIntrlGen.data());
+    xt::xarray<int> infoIntrl = xt::adapt(infoIntrlGen);
+    if (mode == ENC_GEMM)
+        infoIntrl = readBits(path / "info_bit_pattern.txt");
+    XT_TRACE(TRACE_DEBUG, TRACE_FROZEN,
+             xt::print_options::line_width(160) << "infoIntrl:" << std::endl
+                                                << xt::transpose(infoIntrl));
 
     // Frozen bit insertion
-    xt::xarray<int> frozenBits = xt::zeros<int>({params->N});
+    profTimer_s frozenTimer(PROF_FROZEN);
+    auto frozenBits = arenaAdapt<int>(arena, params->N);
     xt::filter(frozenBits, infoIntrl > 0) = intrlBits;
-    std::cout << xt::print_options::line_width(160) << "frozenBits:" << std::endl
-              << xt::transpose(frozenBits) << std::endl;
-
-    // Read encoder matrix
-    fs::path encGenVecPath = path / "enc_gen_m.txt";
-    in_file.open(encGenVecPath);
-    xt::xarray<int> encGenVec = xt::ravel(xt::load_csv<short>(in_file));
-    xt::xarray<int> encGenMtx = xt::transpose(encGenVec.reshape({params->N, params->N}));
-    std::cout << "encGenMtx:" << std::endl
-              << xt::print_options::line_width(160) << xt::print_options::edge_items(20)
-              << encGenMtx << std::endl;
-    in_file.close();
+    frozenTimer.stop();
+    XT_TRACE(TRACE_DEBUG, TRACE_FROZEN,
+             xt::print_options::line_width(160) << "frozenBits:" << std::endl
+                                                << xt::transpose(frozenBits));
 
     // Encoding
-    xt::xarray<int> encBits = xt::linalg::dot(frozenBits, encGenMtx);
-    encBits %= 2;
-    std::cout << xt::print_options::line_width(160) << "encBits:" << std::endl
-              << xt::transpose(encBits) << std::endl;
-
-    // Read rate matching pattern
-    fs::path encIntrlPath = path / "rate_matching_pattern.txt";
-    in_file.open(encIntrlPath);
-    xt::xarray<int> encIntrl = xt::ravel(xt::load_csv<int>(in_file));
-    std::cout << xt::print_options::line_width(160) << "encIntrl:" << std::endl
-              << xt::transpose(encIntrl) << std::endl;
-    in_file.close();
-
-    // Rate matching
-    xt::xarray<int> rmBits = xt::zeros<int>({params->E});
-    rmBits = xt::index_view(encBits, encIntrl);
-    std::cout << xt::print_options::line_width(160) << "rmBits:" << std::endl
-              << xt::transpose(rmBits) << std::endl;
+    auto encBits = arenaAdapt<int>(arena, params->N);
+    if (mode == ENC_GEMM) {
+        // Read encoder matrix
+        fs::path encGenVecPath = path / "enc_gen_m.txt";
+        xt::xarray<int> encGenVec = readBits(encGenVecPath);
+        xt::xarray<int> encGenMtx =
+            xt::transpose(encGenVec.reshape({params->N, params->N}));
+        XT_TRACE(TRACE_DEBUG, TRACE_MTX,
+                 "encGenMtx:" << std::endl << xt::print_options::line_width(160)
+                              << xt::print_options::edge_items(20) << encGenMtx);
 
-    // Read rate matched reference bits
-    fs::path rmRefsPath = path / "rm_bits.txt";
-    in_file.open(rmRefsPath);
-    xt::xarray<int> rmRefs = xt::ravel(xt::load_csv<int>(in_file));
-    std::cout << xt::print_options::line_width(160) << "rmRefs:" << std::endl
-              << xt::transpose(rmRefs) << std::endl;
-    in_file.close();
+        // Reference encoding with generator matrix
+        profTimer_s timer(PROF_ENC);
+        encBits = xt::linalg::dot(frozenBits, encGenMtx);
+        encBits %= 2;
+    } else {
+        // Butterfly encoding in place
+        profTimer_s timer(PROF_ENC);
+        encBits = frozenBits;
+        polarEnc(encBits.data(), params->N);
+    }
+    XT_TRACE(TRACE_DEBUG, TRACE_ENC,
+             xt::print_options::line_width(160) << "encBits:" << std::endl
+                                                << xt::transpose(encBits));
 
-    // Check results
-    xt::xarray<int> checkBits = xt::abs(rmRefs - rmBits);
-    int nDiffBits = xt::sum(checkBits)();
-    std::cout << "nDiffBits: " << nDiffBits << std::endl;
-}
\ No newline at end of file
+    // Rate matching, the stream writes every output bit
+    auto rmBits = arenaAdapt<int>(arena, params->E, false);
+    if (mode == ENC_GEMM) {
+        // Reference gather with the pattern read from the test vector
+        xt::xarray<int> encIntrl = readBits(path / "rate_matching_pattern.txt");
+        XT_TRACE(TRACE_DEBUG, TRACE_RM,
+                 xt::print_options::line_width(160) << "encIntrl:" << std::endl
+                                                    << xt::transpose(encIntrl));
+        profTimer_s timer(PROF_RM);
+        rmBits = xt::index_view(encBits, encIntrl);
+    } else {
+        // Streamed straight from the encoded bits, no pattern
+        profTimer_s timer(PROF_RM);
+        rmStream_s rms;
+        rmStreamInit(&rms, params->K, params->E, params->N);
+        rmStreamBits(&rms, encBits.data(), rmBits.data());
+    }
+    XT_TRACE(TRACE_DEBUG, TRACE_RM,
+             xt::print_options::line_width(160) << "rmBits:" << std::endl
+                                                << xt::transpose(rmBits));
+
+    checkRmBits(path, rmBits);
+    if (mode != ENC_GEMM)
+        checkPatterns(path, params);
+    arenaRelease(arena, mark);
+}
@@ -1,18 +1,15 @@
 #ifndef ENCDL_H_
 #define ENCDL_H_
 
+#include "polarcfg.h"
 #include <filesystem>
 
 namespace fs = std::filesystem;
 
-typedef struct params_s {
-    int A;
-    int P;
-    int K;
-    int E;
-    int N;
-} params_s;
+// Encoding method: table CRC + butterfly, generator matrix reference (CRC and
+// transform), packed bit chain or bit-sliced batch of codewords
+typedef enum encMode_e { ENC_BUTTERFLY, ENC_GEMM, ENC_PACKED, ENC_BATCH } encMode_e;
 
-void encDl(fs::path path, params_s *params);
+void encDl(fs::path path, const polarCfg_s *cfg, encMode_e mode = ENC_BUTTERFLY);
 
 #endif // ENCDL_H_
\ No newline at end of file
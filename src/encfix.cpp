@@ -0,0 +1,23 @@
+#include "encfix.h"
+#include "encdl.h"
+#include "plan.h"
+#include "polarcfg.h"
+
+typedef struct encFix_s {
+    params_s params;
+    planEncFn fn;
+} encFix_s;
+
+// Hot configurations, the test vectors. Each entry is one more instantiation.
+static const encFix_s ENC_FIX_TABLE[] = {
+    {{12, 24, 36, 48, 64, LINK_DL}, Encoder<36, 48, 64>::encode},
+    {{65, 24, 89, 184, 256, LINK_DL}, Encoder<89, 184, 256>::encode},
+    {{134, 24, 158, 267, 512, LINK_DL}, Encoder<158, 267, 512>::encode},
+};
+
+planEncFn encFixFind(const polarCfg_s *cfg) {
+    for (const encFix_s &f : ENC_FIX_TABLE)
+        if (planKey(&f.params) == cfg->key)
+            return f.fn;
+    return nullptr;
+}
@@ -0,0 +1,113 @@
+#ifndef ENCFIX_H_
+#define ENCFIX_H_
+
+#include "crc.h"
+#include "encdl.h"
+#include "pattern.h"
+#include "plan.h"
+#include "polarcfg.h"
+#include "ratematch.h"
+#include "simd.h"
+#include <array>
+#include <cstdint>
+#include <utility>
+
+// Encoders specialized on (K, E, N) for the hot configurations: patterns generated at
+// compile time into std::array tables and a fully unrolled butterfly. planCreate picks
+// one through encFixFind when the parameters match.
+
+// Index tables of one configuration
+template <int K, int E, int N> struct encFixPat_s {
+    std::array<uint16_t, N> uSrc;  // Bit of info + CRC feeding each u bit, K if frozen
+    rmStream_s rm;                 // Rate matching generator
+};
+
+template <int K, int E, int N> constexpr encFixPat_s<K, E, N> encFixMakePat() {
+    encFixPat_s<K, E, N> pat = {};
+    uint16_t crcIntrl[K] = {};
+    uint8_t info[N] = {};
+    patCrcIntrl(K, crcIntrl);
+    patInfoBits(K, E, N, info);
+    rmStreamInit(&pat.rm, K, E, N);
+
+    // CRC interleaver and frozen bit insertion composed into one gather
+    for (int n = 0, k = 0; n < N; ++n)
+        pat.uSrc[n] = info[n] ? crcIntrl[k++] : K;
+    return pat;
+}
+
+// Bits j with (j & s) == 0, the upper halves of the in-word butterflies of stride s
+constexpr uint64_t encFixMask(int s) {
+    uint64_t m = 0;
+    for (int j = 0; j < 64; ++j)
+        if (!(j & s))
+            m |= uint64_t{1} << j;
+    return m;
+}
+
+// One butterfly stage u[j] ^= u[j + S] over packed bits
+template <int N, int S> inline void encFixStage(uint64_t *u) {
+    constexpr int nWords = (N + 63) / 64;
+    if constexpr (S < 64) {
+        constexpr uint64_t m = encFixMask(S);
+        for (int w = 0; w < nWords; ++w)
+            u[w] ^= (u[w] >> S) & m;
+    } else {
+        constexpr int sw = S / 64;
+        for (int w = 0; w < nWords; w += 2 * sw)
+            for (int j = 0; j < sw; ++j)
+                u[w + j] ^= u[w + j + sw];
+    }
+}
+
+template <int N, int... L>
+inline void encFixPolar(uint64_t *u, std::integer_sequence<int, L...>) {
+    (encFixStage<N, (1 << L)>(u), ...);
+}
+
+constexpr int encFixLog2(int N) { return N > 1 ? 1 + encFixLog2(N / 2) : 0; }
+
+template <int K, int E, int N, int P = 24> struct Encoder {
+    static_assert(N >= 32 && N <= PLAN_N_MAX && (N & (N - 1)) == 0, "bad N");
+    static_assert(K > P && K <= PAT_K_IL_MAX && K <= N, "bad K");
+    static_assert(P == 24 || P == 11 || P == 6, "bad CRC length");
+
+    static constexpr int A = K - P;
+    static constexpr encFixPat_s<K, E, N> pat = encFixMakePat<K, E, N>();
+    static constexpr const crcTable_s *crc = P == 24 ? &CRC24C : P == 11 ? &CRC11 : &CRC6;
+
+    // Same contract as planEncode
+    static void encode(const uint64_t *info, uint16_t rnti, uint64_t *rm) {
+        std::array<uint64_t, K / 64 + 1> c = {};
+        std::array<uint64_t, (N + 63) / 64> u = {};
+
+        // CRC computation and RNTI scrambling
+        uint32_t reg = crcUpdate(crc, crc->onesInit, info, A);
+        if constexpr (P >= 16)
+            reg ^= crcReflect(rnti, 16) << (P - 16);
+
+        // CRC attachment
+        for (int w = 0; w < (A + 63) / 64; ++w)
+            c[w] = info[w];
+        if constexpr ((A & 63) != 0)
+            c[A >> 6] &= (uint64_t{1} << (A & 63)) - 1;
+        c[A >> 6] |= uint64_t(reg) << (A & 63);
+        if constexpr ((A & 63) + P > 64)
+            c[(A >> 6) + 1] |= uint64_t(reg) >> (64 - (A & 63));
+
+        // CRC interleaver and frozen bit insertion, frozen bits read the zero bit K
+        const simdKernels_s *simd = simdGet();
+        simd->gatherBits(c.data(), pat.uSrc.data(), N, u.data());
+
+        // Encoding
+        encFixPolar<N>(u.data(), std::make_integer_sequence<int, encFixLog2(N)>{});
+
+        // Rate matching
+        rmStreamPacked(&pat.rm, u.data(), rm);
+    }
+};
+
+// Specialized encoder of a configuration by its key, nullptr when there is none
+planEncFn encFixFind(const polarCfg_s *cfg);
+
+#endif // ENCFIX_H_
@@ -1,3 +1,7 @@
+#include "bitvec.h"
+#include "crc.h"
+#include "gf2.h"
+#include <chrono>
 #include <complex>
 #include <filesystem>
 #include <fstream>
@@ -423,18 +427,10 @@ void ex1_crc_run() {
               << xt::transpose(crc_s) << std::endl;
 }
 
-void ex2_crc_run() {
-    std::cout << "Current path is: " << fs::current_path() << '\n';
-
-    // Read message
-    std::ifstream in_file;
-    in_file.open("./../dl/tv0/info_bits.txt");
-    xt::xarray<int> msg = xt::ravel(xt::load_csv<short>(in_file));
-    std::cout << "msg:" << std::endl << xt::transpose(msg) << std::endl;
-
+xt::xarray<int> ex2_crc_mtx() {
     // CRC vector for remainder
     // clang-format off
-    xt::xarray<int> crc_r_v = {
+    static const xt::xarray<int> crc_r_v = {
         0, 1, 0, 0, 1, 0, 1, 0, 0, 0, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
         1, 1, 1, 0, 1, 1, 1, 1, 0, 0, 1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
         0, 1, 1, 1, 0, 1, 1, 1, 1, 0, 0, 1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
@@ -469,11 +465,34 @@ void ex2_crc_run() {
         0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
     };
     // clang-format on
+    int step = 32;
+    xt::xarray<int> crc_r = crc_r_v;
+    crc_r.reshape({step, step});
+    return crc_r;
+}
+
+xt::xarray<int> ex2_crc(const xt::xarray<int> &crc_r, const xt::xarray<int> &msg) {
+    int step = crc_r.shape(0);
+    xt::xarray<int> p_msg =
+        xt::concatenate(xt::xtuple(msg, xt::zeros<int>({step - int(msg.size())})));
+    xt::xarray<int> crc_s = xt::linalg::dot(crc_r, p_msg);
+    crc_s %= 2;
+    return crc_s;
+}
+
+void ex2_crc_run() {
+    std::cout << "Current path is: " << fs::current_path() << '\n';
+
+    // Read message
+    std::ifstream in_file;
+    in_file.open("./../dl/tv0/info_bits.txt");
+    xt::xarray<int> msg = xt::ravel(xt::load_csv<short>(in_file));
+    std::cout << "msg:" << std::endl << xt::transpose(msg) << std::endl;
 
     // CRC matrix
     int step = 32;
     int pad = step - msg.size();
-    xt::xarray<int> crc_r = crc_r_v.reshape({step, step});
+    xt::xarray<int> crc_r = ex2_crc_mtx();
     std::cout << xt::print_options::line_width(160) << xt::print_options::edge_items(20)
               << "crc_r:" << std::endl
               << crc_r << std::endl;
@@ -500,11 +519,107 @@ void ex2_crc_run() {
               << xt::transpose(crc_s) << std::endl;
 }
 
+void ex3_crc_run() {
+    std::cout << "Current path is: " << fs::current_path() << '\n';
+
+    // Read message
+    std::ifstream in_file;
+    in_file.open("./../dl/tv0/info_bits.txt");
+    xt::xarray<int> msg = xt::ravel(xt::load_csv<short>(in_file));
+    std::cout << "msg:" << std::endl << xt::transpose(msg) << std::endl;
+
+    // Packed message
+    bitvec_s msg_p;
+    bvPack(&msg_p, msg.data(), msg.size());
+
+    // CRC24C with 24 leading ones using slice-by-8 tables
+    bitvec_s crc_p;
+    crcAttach(&CRC24C, &msg_p, &crc_p);
+    xt::xarray<int> crc_s = xt::zeros<int>({CRC24C.L});
+    bvUnpack(&crc_p, crc_s.data());
+    std::cout << xt::print_options::line_width(160) << "crc_s:" << std::endl
+              << xt::transpose(crc_s) << std::endl;
+}
+
+void ex4_crc_run() {
+    std::cout << "Current path is: " << fs::current_path() << '\n';
+    const int nIter = 100000;
+
+    // Read message
+    std::ifstream in_file;
+    in_file.open("./../dl/tv0/info_bits.txt");
+    xt::xarray<int> msg = xt::ravel(xt::load_csv<short>(in_file));
+    in_file.close();
+
+    // Read CRC matrix
+    in_file.open("./../dl/tv0/crc_gen_m.txt");
+    xt::xarray<int> crc_g = xt::ravel(xt::load_csv<short>(in_file));
+    in_file.close();
+    int step = CRC24C.L;
+    xt::xarray<int> crc_m = xt::transpose(crc_g.reshape({step, int(msg.size()) + step}));
+    xt::xarray<int> p_msg = xt::concatenate(xt::xtuple(xt::ones<int>({step}), msg));
+
+    // Packed message
+    bitvec_s msg_p;
+    bvPack(&msg_p, msg.data(), msg.size());
+
+    // CRC computation with matrix times vector
+    xt::xarray<int> crc_s;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < nIter; ++i) {
+        crc_s = xt::linalg::dot(p_msg, crc_m);
+        crc_s %= 2;
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    std::cout << "matrix: "
+              << std::chrono::duration<double, std::nano>(t1 - t0).count() / nIter
+              << " ns" << std::endl;
+
+    // CRC computation with slice-by-8 tables
+    uint32_t reg = 0;
+    t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < nIter; ++i)
+        reg ^= crcUpdateTable(&CRC24C, CRC24C.onesInit, msg_p.words.data(), msg_p.nBits);
+    t1 = std::chrono::steady_clock::now();
+    std::cout << "table: "
+              << std::chrono::duration<double, std::nano>(t1 - t0).count() / nIter
+              << " ns" << std::endl;
+
+    // CRC computation with carry-less multiply
+    if (crcHasClmul()) {
+        t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < nIter; ++i)
+            reg ^= crcUpdateClmul(&CRC24C, CRC24C.onesInit, msg_p.words.data(),
+                                  msg_p.nBits);
+        t1 = std::chrono::steady_clock::now();
+        std::cout << "clmul: "
+                  << std::chrono::duration<double, std::nano>(t1 - t0).count() / nIter
+                  << " ns" << std::endl;
+    }
+
+    // Check all results agree
+    bitvec_s crc_p;
+    crcAttach(&CRC24C, &msg_p, &crc_p);
+    xt::xarray<int> crc_t = xt::zeros<int>({step});
+    bvUnpack(&crc_p, crc_t.data());
+    std::cout << xt::print_options::line_width(160) << "crc_s:" << std::endl
+              << xt::transpose(crc_s) << std::endl
+              << "crc_t:" << std::endl
+              << xt::transpose(crc_t) << std::endl
+              << "reg: " << reg << std::endl;
+}
+
 void ex1_mpow_run() {
-    xt::xarray<double> arr1{{1, 1, 0}, {1, 0, 1}, {0, 0, 0}};
+    // Powers over GF(2) on packed rows, the binary matrices of this repo are never
+    // meant over the reals (xt::linalg::matrix_power would give integer growth)
+    xt::xarray<int> arr1{{1, 1, 0}, {1, 0, 1}, {0, 0, 0}};
     std::cout << "arr1:" << std::endl << arr1 << std::endl;
+    gf2Mat_s m, m_n;
+    gf2FromInt(&m, arr1.data(), arr1.shape(0), arr1.shape(1));
     for (long n = 2; n < 8; ++n) {
-        xt::xarray<double> arr_n = xt::linalg::matrix_power(arr1, n);
+        gf2MatPow(&m, n, &m_n);
+        xt::xarray<int> arr_n = xt::zeros<int>(arr1.shape());
+        gf2ToInt(&m_n, arr_n.data());
         std::cout << "arr^" << n << ":" << std::endl << arr_n << std::endl;
     }
 }
@@ -535,4 +650,8 @@ void ex2_cmplx_run() {
     auto a1_fftshift = xt::fftw::fftshift(a1_fft);
     std::cout << xt::print_options::line_width(160) << "a1_fftshift:" << std::endl
               << a1_fftshift << std::endl;
-}
\ No newline at end of file
+}
+
+xt::xarray<std::complex<double>> ex2_cmplx(const xt::xarray<std::complex<double>> &a) {
+    return xt::fftw::fftshift(xt::fftw::fft(a));
+}
@@ -1,6 +1,9 @@
 #ifndef EX1_H_
 #define EX1_H_
 
+#include <complex>
+#include <xtensor/xarray.hpp>
+
 void ex1_run();
 void ex2_run();
 void ex3_run();
@@ -25,9 +28,17 @@ void ex1_man_run();
 
 void ex1_crc_run();
 void ex2_crc_run();
+void ex3_crc_run();
+void ex4_crc_run();
 void ex1_mpow_run();
 
 void ex1_cmplx_run();
 void ex2_cmplx_run();
 
+// Kernels of ex2_crc_run and ex2_cmplx_run without the printing, for benchmarks.
+// ex2_crc is one step of the 32 x 32 CRC matrix on msg zero padded to 32 bits.
+xt::xarray<int> ex2_crc_mtx();
+xt::xarray<int> ex2_crc(const xt::xarray<int> &crc_r, const xt::xarray<int> &msg);
+xt::xarray<std::complex<double>> ex2_cmplx(const xt::xarray<std::complex<double>> &a);
+
 #endif // EX1_H_
@@ -0,0 +1,145 @@
+#include "gf2.h"
+#include "bitvec.h"
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+#define GF2_M4R_BITS 8
+#define GF2_M4R_SIZE (1 << GF2_M4R_BITS)
+
+void gf2Init(gf2Mat_s *m, int rows, int cols) {
+    m->rows = rows;
+    m->cols = cols;
+    m->stride = bvWords(cols);
+    m->words.assign(size_t(rows) * m->stride, 0);
+}
+
+void gf2Identity(gf2Mat_s *m, int n) {
+    gf2Init(m, n, n);
+    for (int i = 0; i < n; ++i)
+        gf2Row(m, i)[i >> 6] = uint64_t{1} << (i & 63);
+}
+
+void gf2FromInt(gf2Mat_s *m, const int *a, int rows, int cols) {
+    gf2Init(m, rows, cols);
+    for (int i = 0; i < rows; ++i) {
+        uint64_t *row = gf2Row(m, i);
+        for (int j = 0; j < cols; ++j)
+            row[j >> 6] |= uint64_t(a[size_t(i) * cols + j] & 1) << (j & 63);
+    }
+}
+
+void gf2ToInt(const gf2Mat_s *m, int *a) {
+    for (int i = 0; i < m->rows; ++i)
+        for (int j = 0; j < m->cols; ++j)
+            a[size_t(i) * m->cols + j] = gf2Get(m, i, j);
+}
+
+void gf2Transpose(const gf2Mat_s *m, gf2Mat_s *t) {
+    gf2Init(t, m->cols, m->rows);
+    // 64 x 64 blocks, zero padded past the last row
+    uint64_t blk[64];
+    for (int bi = 0; bi < m->rows; bi += 64)
+        for (int bj = 0; bj < m->stride; ++bj) {
+            int n = std::min(64, m->rows - bi);
+            for (int i = 0; i < 64; ++i)
+                blk[i] = i < n ? gf2Row(m, bi + i)[bj] : 0;
+            bvTranspose64(blk);
+            int nOut = std::min(64, m->cols - bj * 64);
+            for (int j = 0; j < nOut; ++j)
+                gf2Row(t, bj * 64 + j)[bi >> 6] = blk[j];
+        }
+}
+
+void gf2MatVec(const gf2Mat_s *m, const uint64_t *x, uint64_t *y) {
+    std::fill(y, y + bvWords(m->rows), 0);
+    for (int i = 0; i < m->rows; ++i)
+        y[i >> 6] |= uint64_t(gf2Dot(gf2Row(m, i), x, m->stride)) << (i & 63);
+}
+
+// Subset XORs of rows [r0, r0 + 8) of m into tab, rows past the end count as zero.
+// Each entry is a previous one plus its lowest row.
+static void gf2M4rGroup(const gf2Mat_s *m, int r0, uint64_t *tab) {
+    int stride = m->stride;
+    std::fill(tab, tab + stride, 0);
+    for (int s = 1; s < GF2_M4R_SIZE; ++s) {
+        int r = r0 + __builtin_ctz(s);
+        const uint64_t *prev = tab + (s & (s - 1)) * stride;
+        uint64_t *dst = tab + s * stride;
+        if (r < m->rows) {
+            const uint64_t *row = gf2Row(m, r);
+            for (int w = 0; w < stride; ++w)
+                dst[w] = prev[w] ^ row[w];
+        } else {
+            std::copy(prev, prev + stride, dst);
+        }
+    }
+}
+
+void gf2M4rInit(gf2M4r_s *t, const gf2Mat_s *m) {
+    int nGroups = (m->rows + GF2_M4R_BITS - 1) / GF2_M4R_BITS;
+    t->rows = m->rows;
+    t->cols = m->cols;
+    t->stride = m->stride;
+    t->tab.resize(size_t(nGroups) * GF2_M4R_SIZE * m->stride);
+    for (int g = 0; g < nGroups; ++g)
+        gf2M4rGroup(m, g * GF2_M4R_BITS,
+                    &t->tab[size_t(g) * GF2_M4R_SIZE * m->stride]);
+}
+
+void gf2M4rVecMat(const gf2M4r_s *t, const uint64_t *x, uint64_t *y) {
+    int stride = t->stride;
+    std::fill(y, y + stride, 0);
+    int nGroups = (t->rows + GF2_M4R_BITS - 1) / GF2_M4R_BITS;
+    const uint64_t *tab = t->tab.data();
+    for (int g = 0; g < nGroups; ++g, tab += GF2_M4R_SIZE * stride) {
+        // 8 divides 64, a group never straddles words of x
+        int s = (x[g >> 3] >> ((g & 7) * GF2_M4R_BITS)) & (GF2_M4R_SIZE - 1);
+        if (!s)
+            continue;
+        const uint64_t *e = tab + s * stride;
+        for (int w = 0; w < stride; ++w)
+            y[w] ^= e[w];
+    }
+}
+
+void gf2MatMul(const gf2Mat_s *a, const gf2Mat_s *b, gf2Mat_s *c) {
+    if (a->cols != b->rows)
+        throw std::runtime_error("GF(2) matrix shapes do not match");
+    gf2Init(c, a->rows, b->cols);
+    int stride = b->stride;
+    std::vector<uint64_t> tab(size_t(GF2_M4R_SIZE) * stride);
+
+    // Row i of c is row i of a times b: per group of 8 rows of b one table lookup
+    for (int r0 = 0; r0 < b->rows; r0 += GF2_M4R_BITS) {
+        gf2M4rGroup(b, r0, tab.data());
+        int w0 = r0 >> 6, sh = r0 & 63;
+        for (int i = 0; i < a->rows; ++i) {
+            int s = (gf2Row(a, i)[w0] >> sh) & (GF2_M4R_SIZE - 1);
+            if (!s)
+                continue;
+            const uint64_t *e = &tab[size_t(s) * stride];
+            uint64_t *dst = gf2Row(c, i);
+            for (int w = 0; w < stride; ++w)
+                dst[w] ^= e[w];
+        }
+    }
+}
+
+void gf2MatPow(const gf2Mat_s *m, long n, gf2Mat_s *p) {
+    if (m->rows != m->cols || n < 0)
+        throw std::runtime_error("GF(2) matrix power needs a square matrix, n >= 0");
+    gf2Identity(p, m->rows);
+    gf2Mat_s sq = *m, tmp;
+    for (; n; n >>= 1) {
+        if (n & 1) {
+            gf2MatMul(p, &sq, &tmp);
+            std::swap(*p, tmp);
+        }
+        if (n > 1) {
+            gf2MatMul(&sq, &sq, &tmp);
+            std::swap(sq, tmp);
+        }
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef GF2_H_
+#define GF2_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Linear algebra over GF(2) on bit-packed rows, for generator and parity matrices of
+// arbitrary codes where the dense int GEMM + %2 form would otherwise be used. Vectors
+// are packed as bitvec_s words (bit j in word j / 64 at position j % 64).
+
+// rows x cols matrix, bit j of row i at bit j of gf2Row(m, i). Unused bits of each row
+// are kept zero.
+typedef struct gf2Mat_s {
+    int rows;
+    int cols;
+    int stride; // Words per row
+    std::vector<uint64_t> words;
+} gf2Mat_s;
+
+inline uint64_t *gf2Row(gf2Mat_s *m, int i) { return &m->words[size_t(i) * m->stride]; }
+inline const uint64_t *gf2Row(const gf2Mat_s *m, int i) {
+    return &m->words[size_t(i) * m->stride];
+}
+
+inline int gf2Get(const gf2Mat_s *m, int i, int j) {
+    return (gf2Row(m, i)[j >> 6] >> (j & 63)) & 1;
+}
+
+inline void gf2Set(gf2Mat_s *m, int i, int j, int b) {
+    uint64_t bit = uint64_t{1} << (j & 63);
+    uint64_t *w = &gf2Row(m, i)[j >> 6];
+    *w = (*w & ~bit) | (b ? bit : 0);
+}
+
+// Parity of a AND b over nWords words, the GF(2) dot product
+inline int gf2Dot(const uint64_t *a, const uint64_t *b, int nWords) {
+    uint64_t acc = 0;
+    for (int w = 0; w < nWords; ++w)
+        acc ^= a[w] & b[w];
+    return __builtin_parityll(acc);
+}
+
+void gf2Init(gf2Mat_s *m, int rows, int cols);
+void gf2Identity(gf2Mat_s *m, int n);
+
+// From / to row-major int matrices, e.g. xt::xarray<int> data, entries taken mod 2
+void gf2FromInt(gf2Mat_s *m, const int *a, int rows, int cols);
+void gf2ToInt(const gf2Mat_s *m, int *a);
+
+void gf2Transpose(const gf2Mat_s *m, gf2Mat_s *t);
+
+// y = m x, x of cols bits, y of rows bits. One AND + popcount dot per row.
+void gf2MatVec(const gf2Mat_s *m, const uint64_t *x, uint64_t *y);
+
+// Method of Four Russians tables of a matrix: for every group of 8 rows the XOR of
+// all 256 subsets, so x m costs one row XOR per 8 bits of x. rows / 8 * 256 rows of
+// storage, 4 MB for 1024 x 1024, worth it for a fixed matrix applied many times.
+typedef struct gf2M4r_s {
+    int rows;
+    int cols;
+    int stride;
+    std::vector<uint64_t> tab; // Entry s of group g at (g * 256 + s) * stride
+} gf2M4r_s;
+
+void gf2M4rInit(gf2M4r_s *t, const gf2Mat_s *m);
+
+// y = x m, x of rows bits, y of cols bits (the row vector form of dot(u, G))
+void gf2M4rVecMat(const gf2M4r_s *t, const uint64_t *x, uint64_t *y);
+
+// c = a b by Four Russians, tables of b built per call. c must not alias a or b.
+void gf2MatMul(const gf2Mat_s *a, const gf2Mat_s *b, gf2Mat_s *c);
+
+// p = m^n of a square m by repeated squaring, m^0 is the identity
+void gf2MatPow(const gf2Mat_s *m, long n, gf2Mat_s *p);
+
+#endif // GF2_H_
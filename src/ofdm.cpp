@@ -0,0 +1,184 @@
+#include "ofdm.h"
+#include "arena.h"
+#include "bitvec.h"
+#include "plan.h"
+#include "prof.h"
+#include "util.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+#include <xtensor/xarray.hpp>
+
+namespace fs = std::filesystem;
+
+// Batched plans by (nFft, nSym, sign), kept for the life of the process. The FFTW
+// planner is not thread safe, executing a plan on new arrays is.
+static std::mutex ofdmPlanMtx;
+static std::map<std::tuple<int, int, int>, fftwf_plan> ofdmPlans;
+
+static fftwf_plan ofdmPlan(int nFft, int nSym, int sign) {
+    std::lock_guard<std::mutex> lock(ofdmPlanMtx);
+    auto key = std::make_tuple(nFft, nSym, sign);
+    auto it = ofdmPlans.find(key);
+    if (it != ofdmPlans.end())
+        return it->second;
+
+    // Wisdom of earlier runs, once
+    const char *wisdom = std::getenv("XT_FFTW_WISDOM");
+    static bool wisdomLoaded = false;
+    if (wisdom && !wisdomLoaded)
+        fftwf_import_wisdom_from_filename(wisdom);
+    wisdomLoaded = true;
+
+    // Measure on a scratch buffer, in place like every later execution.
+    // fftwf_malloc alignment is the same for all buffers, so the plan may run on any.
+    auto *buf = (fftwf_complex *)fftwf_malloc(sizeof(fftwf_complex) * nFft * nSym);
+    fftwf_plan plan = fftwf_plan_many_dft(1, &nFft, nSym, buf, nullptr, 1, nFft, buf,
+                                          nullptr, 1, nFft, sign, FFTW_MEASURE);
+    fftwf_free(buf);
+    if (!plan)
+        throw std::runtime_error("FFTW planning failed");
+    if (wisdom)
+        fftwf_export_wisdom_to_filename(wisdom);
+    ofdmPlans[key] = plan;
+    return plan;
+}
+
+void ofdmFit(int E, ofdmParams_s *params) {
+    params->nFft = 256;
+    params->nSc = 12 * 12;
+    params->nSym = std::max(1, ((E + 1) / 2 + params->nSc - 1) / params->nSc);
+    params->nCp = 18; // 144 at 2048, scaled
+}
+
+void ofdmCreate(ofdm_s *ofdm, const ofdmParams_s *params) {
+    if (params->nSc > params->nFft || params->nSym < 1 || params->nCp > params->nFft)
+        throw std::runtime_error("unsupported OFDM numerology");
+    ofdm->params = *params;
+    ofdm->plan = ofdmPlan(params->nFft, params->nSym, FFTW_BACKWARD);
+    ofdm->grid = (std::complex<float> *)fftwf_malloc(sizeof(fftwf_complex) *
+                                                      params->nFft * params->nSym);
+
+    // Subcarrier k is at frequency k - nSc / 2: negative frequencies wrap to the top
+    // bins, so no fftshift pass is needed
+    ofdm->reBin.resize(params->nSc);
+    for (int k = 0; k < params->nSc; ++k)
+        ofdm->reBin[k] = (k - params->nSc / 2 + params->nFft) % params->nFft;
+}
+
+void ofdmDestroy(ofdm_s *ofdm) {
+    fftwf_free(ofdm->grid);
+    ofdm->grid = nullptr;
+}
+
+// QPSK of bit pairs b0 | b1 << 1: ((1 - 2 b0) + j (1 - 2 b1)) / sqrt(2)
+static const float OFDM_A = 0.70710678f;
+static const std::complex<float> OFDM_QPSK[4] = {
+    {OFDM_A, OFDM_A}, {-OFDM_A, OFDM_A}, {OFDM_A, -OFDM_A}, {-OFDM_A, -OFDM_A}};
+
+// Symbol i of nBits packed bits. Pairs start on even bits, never straddling a word.
+static inline std::complex<float> ofdmSym(const uint64_t *bits, int i, int nBits) {
+    int pair = (bits[i >> 5] >> ((2 * i) & 63)) & 3;
+    return OFDM_QPSK[2 * i + 1 == nBits ? pair & 1 : pair];
+}
+
+void ofdmQpsk(const uint64_t *bits, int nBits, std::complex<float> *sym) {
+    for (int i = 0; i < (nBits + 1) / 2; ++i)
+        sym[i] = ofdmSym(bits, i, nBits);
+}
+
+void ofdmModulate(ofdm_s *ofdm, const uint64_t *rm, int E, std::complex<float> *out) {
+    const ofdmParams_s *p = &ofdm->params;
+    int nQpsk = (E + 1) / 2;
+    if (nQpsk > p->nSc * p->nSym)
+        throw std::runtime_error("rate matched bits exceed the OFDM grid");
+    profTimer_s timer(PROF_OFDM);
+
+    // QPSK straight onto the resource elements, the rest of the grid zero
+    std::fill(ofdm->grid, ofdm->grid + p->nFft * p->nSym, std::complex<float>{});
+    for (int s = 0, q = 0; s < p->nSym && q < nQpsk; ++s) {
+        int n = std::min(p->nSc, nQpsk - q);
+        std::complex<float> *sym = ofdm->grid + s * p->nFft;
+        for (int k = 0; k < n; ++k, ++q)
+            sym[ofdm->reBin[k]] = ofdmSym(rm, q, E);
+    }
+
+    // IFFT of all symbols, in place
+    fftwf_execute_dft(ofdm->plan, (fftwf_complex *)ofdm->grid,
+                      (fftwf_complex *)ofdm->grid);
+
+    // Cyclic prefix and scaling
+    float scale = 1.0f / std::sqrt(float(p->nFft));
+    for (int s = 0; s < p->nSym; ++s) {
+        const std::complex<float> *sym = ofdm->grid + s * p->nFft;
+        std::complex<float> *dst = out + s * (p->nCp + p->nFft);
+        for (int t = 0; t < p->nCp; ++t)
+            dst[t] = sym[p->nFft - p->nCp + t] * scale;
+        for (int t = 0; t < p->nFft; ++t)
+            dst[p->nCp + t] = sym[t] * scale;
+    }
+}
+
+void ofdmDl(fs::path path, const polarCfg_s *cfg) {
+    const params_s *params = &cfg->params;
+    const int nIter = 1000;
+    std::shared_ptr<const plan_s> plan = planGet(planCacheDefault(), cfg);
+
+    // Read info and RNTI bits, RNTI MSB first
+    bitvec_s infoBits;
+    readPacked(path / "info_bits.txt", params->A, &infoBits);
+    uint16_t rnti = readRnti(path / "rnti_bits.txt");
+
+    bitvec_s rmBits;
+    bvInit(&rmBits, params->E);
+    planEncode(plan.get(), infoBits.words.data(), rnti, rmBits.words.data());
+
+    // Modulate, timed after the first slot has warmed the plan and buffers
+    ofdmParams_s op;
+    ofdmFit(params->E, &op);
+    ofdm_s ofdm;
+    ofdmCreate(&ofdm, &op);
+    std::vector<std::complex<float>> samples(op.nSym * (op.nCp + op.nFft));
+    ofdmModulate(&ofdm, rmBits.words.data(), params->E, samples.data());
+    int64_t nAllocs = allocCount();
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < nIter; ++i)
+        ofdmModulate(&ofdm, rmBits.words.data(), params->E, samples.data());
+    auto t1 = std::chrono::steady_clock::now();
+
+    // Check: forward DFT of the samples without prefix, hard QPSK decisions
+    fftwf_plan fwd = ofdmPlan(op.nFft, op.nSym, FFTW_FORWARD);
+    size_t nRx = size_t(op.nFft) * op.nSym;
+    auto *rxBuf = (fftwf_complex *)fftwf_malloc(sizeof(fftwf_complex) * nRx);
+    auto *rx = (std::complex<float> *)rxBuf;
+    for (int s = 0; s < op.nSym; ++s)
+        std::copy_n(samples.begin() + s * (op.nCp + op.nFft) + op.nCp, op.nFft,
+                    rx + s * op.nFft);
+    fftwf_execute_dft(fwd, rxBuf, rxBuf);
+    int nDiffBits = 0;
+    for (int e = 0; e < params->E; ++e) {
+        int q = e / 2;
+        std::complex<float> y = rx[q / op.nSc * op.nFft + ofdm.reBin[q % op.nSc]];
+        nDiffBits += ((e & 1 ? y.imag() : y.real()) < 0) != bvGet(&rmBits, e);
+    }
+    fftwf_free(rxBuf);
+    ofdmDestroy(&ofdm);
+
+    double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / nIter;
+    std::cout << "ofdm " << op.nSym << " x " << op.nFft << ": nDiffBits " << nDiffBits
+              << ", " << ns << " ns" << std::endl;
+    if (nAllocs >= 0)
+        std::cout << "nAllocs per slot: " << (allocCount() - nAllocs) / double(nIter)
+                  << std::endl;
+}
@@ -0,0 +1,51 @@
+#ifndef OFDM_H_
+#define OFDM_H_
+
+#include "encdl.h"
+#include <complex>
+#include <cstdint>
+#include <filesystem>
+#include <fftw3.h>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Modulation after rate matching: QPSK mapping (38.211 5.1.3), resource element
+// mapping onto nSc subcarriers centred on DC, frequency first then symbol, and the
+// IFFT + cyclic prefix of all symbols of a slot in one batched FFTW plan.
+typedef struct ofdmParams_s {
+    int nFft;
+    int nSc;  // Occupied subcarriers, <= nFft
+    int nSym; // OFDM symbols
+    int nCp;  // Cyclic prefix samples
+} ofdmParams_s;
+
+// Modulator of one configuration. The grid buffer makes it single threaded, use one
+// per thread; the FFTW plan is shared through a process wide cache.
+typedef struct ofdm_s {
+    ofdmParams_s params;
+    fftwf_plan plan;           // In-place backward DFT of nSym x nFft, not owned
+    std::complex<float> *grid; // nSym x nFft, fftwf_malloc aligned
+    std::vector<int> reBin;    // nSc, FFT bin of subcarrier k: fftshift as an index map
+} ofdm_s;
+
+// Slot numerology fitting E rate matched bits: nFft 256 with 12 resource blocks and
+// the normal cyclic prefix, as many symbols as the QPSK symbols need
+void ofdmFit(int E, ofdmParams_s *params);
+
+// Plans come from FFTW_MEASURE, with the wisdom file of the XT_FFTW_WISDOM environment
+// variable loaded before the first and saved after each new plan
+void ofdmCreate(ofdm_s *ofdm, const ofdmParams_s *params);
+void ofdmDestroy(ofdm_s *ofdm);
+
+// QPSK symbols of nBits packed bits, an odd last bit is padded with 0
+void ofdmQpsk(const uint64_t *bits, int nBits, std::complex<float> *sym);
+
+// Time samples of E packed rate matched bits, nSym * (nCp + nFft) into out, scaled by
+// 1 / sqrt(nFft) for unit average power per subcarrier. No allocation.
+void ofdmModulate(ofdm_s *ofdm, const uint64_t *rm, int E, std::complex<float> *out);
+
+// Encode a test vector and modulate the rate matched bits
+void ofdmDl(fs::path path, const polarCfg_s *cfg);
+
+#endif // OFDM_H_
@@ -0,0 +1,258 @@
+#include "plan.h"
+#include "bitvec.h"
+#include "crc.h"
+#include "encdl.h"
+#include "encfix.h"
+#include "pattern.h"
+#include "polar.h"
+#include "polarcfg.h"
+#include "ratematch.h"
+#include "simd.h"
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+uint64_t planKey(const params_s *params) {
+    return (uint64_t(params->A & 0xffff) << 48) | (uint64_t(params->link & 1) << 47) |
+           (uint64_t(params->K & 0x7fff) << 32) | (uint64_t(params->E & 0xffff) << 16) |
+           (uint64_t(params->N & 0x7ff) << 5) | uint64_t(params->P & 0x1f);
+}
+
+void planUlParams(int A, int E, params_s *params) {
+    int C = patUciSeg(A, E);
+    params->A = A;
+    params->P = patUciCrc(A);
+    params->K = (A + C - 1) / C + params->P;
+    params->E = E;
+    params->N = 1 << patPolarN(params->K, E / C, 10);
+    params->link = LINK_UL;
+}
+
+void planCreate(plan_s *plan, const polarCfg_s *cfg) {
+    const params_s *params = &cfg->params;
+    bool ul = params->link == LINK_UL;
+    plan->params = *params;
+    plan->crc = crcSelect(params->P);
+
+    // Code blocks, the downlink has one
+    plan->nSeg = cfg->nSeg;
+    plan->segA = params->K - params->P;
+    plan->segFill = plan->nSeg * plan->segA - params->A;
+    plan->segE = cfg->segE;
+    int nPC = ul ? patUciPc(params->K) : 0;
+    int nWm = ul ? patUciPcWm(params->K, plan->segE) : 0;
+
+    // Patterns as compact index arrays, the uplink has no CRC interleaver (I_IL = 0)
+    plan->crcIntrl.resize(params->K);
+    if (ul)
+        std::iota(plan->crcIntrl.begin(), plan->crcIntrl.end(), 0);
+    else
+        patCrcIntrl(params->K, plan->crcIntrl.data());
+    rmStreamInit(&plan->rmStream, params->K, plan->segE, params->N, ul);
+    std::vector<uint16_t> encIdx(params->N);
+    std::iota(encIdx.begin(), encIdx.end(), 0);
+    plan->rmIdx.resize(plan->segE);
+    rmStreamBits(&plan->rmStream, encIdx.data(), plan->rmIdx.data());
+    std::vector<uint8_t> infoIntrl(params->N);
+    patInfoBits(params->K, plan->segE, params->N, infoIntrl.data(), nPC);
+    patPcBits(nPC, nWm, params->N, infoIntrl.data());
+
+    // Frozen mask, info and parity check bit positions
+    bvInit(&plan->frozenMask, params->N);
+    plan->infoPos.clear();
+    plan->pcPos.clear();
+    for (int i = 0; i < params->N; ++i) {
+        if (infoIntrl[i] > 0)
+            bvSet(&plan->frozenMask, i, 1);
+        if (infoIntrl[i] == 1)
+            plan->infoPos.push_back(i);
+        if (infoIntrl[i] == 2)
+            plan->pcPos.push_back(i);
+    }
+    if ((int)plan->infoPos.size() != params->K)
+        throw std::runtime_error("info bit pattern does not match K");
+
+    // Parity check bit n is the XOR of the info bits before it with the same index
+    // mod 5, the 5-bit cyclic shift register of 5.3.1.2 unrolled. Only info bits update
+    // the register, parity check bits read it.
+    int nWords = bvWords(params->N);
+    plan->pcMask.assign(plan->pcPos.size() * nWords, 0);
+    for (size_t j = 0; j < plan->pcPos.size(); ++j)
+        for (int m : plan->infoPos)
+            if (m < plan->pcPos[j] && m % 5 == plan->pcPos[j] % 5)
+                plan->pcMask[j * nWords + (m >> 6)] |= uint64_t{1} << (m & 63);
+
+    // Frozen bit insertion as a gather, frozen bits read the zero bit past K
+    plan->uSrc.assign(params->N, params->K);
+    for (int k = 0; k < params->K; ++k)
+        plan->uSrc[plan->infoPos[k]] = k;
+
+    // Same gather straight from the info + CRC bits
+    plan->uSrcCrc.assign(params->N, params->K);
+    for (int k = 0; k < params->K; ++k)
+        plan->uSrcCrc[plan->infoPos[k]] = plan->crcIntrl[k];
+
+    // Compile-time specialized encoder of hot configurations
+    plan->fixedEnc = ul ? nullptr : encFixFind(cfg);
+}
+
+uint32_t planRntiMask(const plan_s *plan, uint16_t rnti) {
+    if (plan->params.P < 16)
+        return 0;
+    return crcReflect(rnti, 16) << (plan->params.P - 16);
+}
+
+void planEncode(const plan_s *plan, const uint64_t *info, uint16_t rnti, uint64_t *rm) {
+    if (plan->fixedEnc)
+        plan->fixedEnc(info, rnti, rm);
+    else if (plan->params.link == LINK_UL)
+        planEncodeUl(plan, info, rm);
+    else
+        planEncodeGeneric(plan, info, rnti, rm);
+}
+
+void planFrozenInsert(const plan_s *plan, const uint64_t *info, uint16_t rnti,
+                      uint64_t *u) {
+    const params_s *p = &plan->params;
+    uint64_t c[PLAN_K_MAX / 64] = {};
+
+    // CRC computation and RNTI scrambling
+    uint32_t crc = crcUpdate(plan->crc, plan->crc->onesInit, info, p->A);
+    crc ^= planRntiMask(plan, rnti);
+
+    // CRC attachment
+    int nInfoWords = bvWords(p->A);
+    for (int w = 0; w < nInfoWords; ++w)
+        c[w] = info[w];
+    if (p->A & 63)
+        c[nInfoWords - 1] &= (uint64_t{1} << (p->A & 63)) - 1;
+    int off = p->A >> 6, sh = p->A & 63;
+    c[off] |= uint64_t(crc) << sh;
+    if (sh + p->P > 64)
+        c[off + 1] |= uint64_t(crc) >> (64 - sh);
+
+    // CRC interleaver and frozen bit insertion with the composite permutation,
+    // frozen bits read the zero bit K
+    simdGet()->gatherBits(c, plan->uSrcCrc.data(), p->N, u);
+}
+
+void planEncodeGeneric(const plan_s *plan, const uint64_t *info, uint16_t rnti,
+                       uint64_t *rm) {
+    const params_s *p = &plan->params;
+    uint64_t u[PLAN_N_MAX / 64];
+
+    // u-vector in one pass
+    planFrozenInsert(plan, info, rnti, u);
+
+    // Encoding
+    polarEncPacked(u, p->N);
+
+    // Rate matching streamed into rm
+    rmStreamPacked(&plan->rmStream, u, rm);
+}
+
+// OR n bits of src from bit srcOff into dst from bit dstOff
+static void planOrBits(const uint64_t *src, int srcOff, int n, uint64_t *dst,
+                       int dstOff) {
+    while (n > 0) {
+        int len = std::min(64 - (dstOff & 63), n);
+        int w = srcOff >> 6, sh = srcOff & 63;
+        uint64_t v = src[w] >> sh;
+        if (sh + len > 64)
+            v |= src[w + 1] << (64 - sh);
+        if (len < 64)
+            v &= (uint64_t{1} << len) - 1;
+        dst[dstOff >> 6] |= v << (dstOff & 63);
+        srcOff += len;
+        dstOff += len;
+        n -= len;
+    }
+}
+
+void planEncodeUl(const plan_s *plan, const uint64_t *info, uint64_t *rm) {
+    const params_s *p = &plan->params;
+    const simdKernels_s *simd = simdGet();
+    int nWords = bvWords(p->N);
+    std::fill(rm, rm + bvWords(p->E), 0);
+    for (int r = 0, a = 0; r < plan->nSeg; ++r) {
+        uint64_t c[PLAN_K_MAX / 64 + 1] = {}, u[PLAN_N_MAX / 64];
+
+        // Code block segmentation, the filler zeros lead the first block
+        int fill = r == 0 ? plan->segFill : 0;
+        planOrBits(info, a, plan->segA - fill, c, fill);
+        a += plan->segA - fill;
+
+        // CRC attachment, no leading ones or scrambling for UCI
+        uint64_t crc = crcUpdate(plan->crc, 0, c, plan->segA);
+        planOrBits(&crc, 0, p->P, c, plan->segA);
+
+        // Frozen bit insertion, then the parity check bits. Their masks cover info bits
+        // only, so each reads the gathered u independent of the others.
+        simd->gatherBits(c, plan->uSrcCrc.data(), p->N, u);
+        for (size_t j = 0; j < plan->pcPos.size(); ++j) {
+            const uint64_t *mask = &plan->pcMask[j * nWords];
+            uint64_t acc = 0;
+            for (int w = 0; w < nWords; ++w)
+                acc ^= u[w] & mask[w];
+            int n = plan->pcPos[j];
+            u[n >> 6] |= uint64_t(__builtin_parityll(acc)) << (n & 63);
+        }
+
+        // Encoding
+        polarEncPacked(u, p->N);
+
+        // Rate matching with channel interleaving, blocks concatenated into rm
+        if (r == 0) {
+            rmStreamPacked(&plan->rmStream, u, rm);
+        } else {
+            uint64_t f[(0xffff + 63) / 64];
+            rmStreamPacked(&plan->rmStream, u, f);
+            planOrBits(f, 0, plan->segE, rm, r * plan->segE);
+        }
+    }
+}
+
+planCache_s *planCacheDefault() {
+    static planCache_s cache{16, {}, {}, {}};
+    return &cache;
+}
+
+std::shared_ptr<const plan_s> planGet(planCache_s *cache, const polarCfg_s *cfg) {
+    uint64_t key = cfg->key;
+
+    // Hit, move to front
+    {
+        std::lock_guard<std::mutex> lock(cache->mtx);
+        auto it = cache->map.find(key);
+        if (it != cache->map.end()) {
+            cache->lru.splice(cache->lru.begin(), cache->lru, it->second);
+            return *it->second;
+        }
+    }
+
+    // Miss, build outside the lock
+    auto plan = std::make_shared<plan_s>();
+    planCreate(plan.get(), cfg);
+
+    std::lock_guard<std::mutex> lock(cache->mtx);
+    auto it = cache->map.find(key);
+    if (it != cache->map.end())
+        return *it->second;
+    cache->lru.push_front(plan);
+    cache->map[key] = cache->lru.begin();
+    while (cache->lru.size() > cache->capacity) {
+        cache->map.erase(planKey(&cache->lru.back()->params));
+        cache->lru.pop_back();
+    }
+    return plan;
+}
+
+std::shared_ptr<const plan_s> planGet(planCache_s *cache, const params_s *params) {
+    polarCfg_s cfg;
+    polarCfgInit(&cfg, params);
+    return planGet(cache, &cfg);
+}
@@ -0,0 +1,89 @@
+#ifndef PLAN_H_
+#define PLAN_H_
+
+#include "bitvec.h"
+#include "crc.h"
+#include "encdl.h"
+#include "polarcfg.h"
+#include "ratematch.h"
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Largest mother code length and CRC + info length handled by the plan hot path
+#define PLAN_N_MAX 1024
+#define PLAN_K_MAX 1024
+
+// Encoder of one fixed configuration, same contract as planEncode
+typedef void (*planEncFn)(const uint64_t *info, uint16_t rnti, uint64_t *rm);
+
+// Everything encoding needs that depends only on params_s, built once
+typedef struct plan_s {
+    params_s params;
+    const crcTable_s *crc;
+    std::vector<uint16_t> crcIntrl; // K, CRC interleaver over info + CRC bits
+    std::vector<uint16_t> infoPos;  // K, u-vector positions of the info bits
+    std::vector<uint16_t> uSrc;     // N, interleaved bit of each u bit, K if frozen
+    std::vector<uint16_t> uSrcCrc;  // N, crcIntrl o uSrc: info + CRC bit of each u bit
+    std::vector<uint16_t> rmIdx;    // E, rate matching gather, decoder and batch
+    rmStream_s rmStream;            // Rate matching generator of the encoder
+    int nSeg;                       // Code blocks, 2 for segmented UCI
+    int segA;                       // Payload bits per code block
+    int segFill;                    // Zero bits leading the first block
+    int segE;                       // Rate matched bits per code block
+    std::vector<uint16_t> pcPos;    // Parity check bit positions (UCI), ascending
+    std::vector<uint64_t> pcMask;   // bvWords(N) per PC bit, info bits it covers
+    bitvec_s frozenMask;            // N, 1 on info bit positions
+    planEncFn fixedEnc;             // Specialized encoder or nullptr
+} plan_s;
+
+// Key of the (A, P, K, E, N) configuration
+uint64_t planKey(const params_s *params);
+
+// Uplink UCI parameters of an A bit payload rate matched to E bits (6.3.1)
+void planUlParams(int A, int E, params_s *params);
+
+// Build a plan of a validated configuration with generated 38.212 patterns, the
+// segmentation, parity check and channel interleaver tables for the uplink
+void planCreate(plan_s *plan, const polarCfg_s *cfg);
+
+// CRC scrambling mask of a 16-bit RNTI, MSB first
+uint32_t planRntiMask(const plan_s *plan, uint16_t rnti);
+
+// Encode A packed info bits into E packed rate matched bits. No file I/O and no
+// allocation, rm must hold bvWords(E) words. Runs the specialized encoder of the
+// configuration when there is one, the generic or uplink engine otherwise. Uplink
+// plans ignore rnti.
+void planEncode(const plan_s *plan, const uint64_t *info, uint16_t rnti, uint64_t *rm);
+// Fused CRC attachment, RNTI scrambling, CRC interleaving and frozen bit insertion:
+// the N u-vector bits gathered from the info bits and CRC remainder in one pass
+void planFrozenInsert(const plan_s *plan, const uint64_t *info, uint16_t rnti,
+                      uint64_t *u);
+
+void planEncodeGeneric(const plan_s *plan, const uint64_t *info, uint16_t rnti,
+                       uint64_t *rm);
+
+// Uplink UCI chain: segmentation, CRC6 / CRC11 per block, parity check bits, polar
+// encoding, rate matching with channel interleaving and block concatenation
+void planEncodeUl(const plan_s *plan, const uint64_t *info, uint64_t *rm);
+
+// Thread-safe LRU cache of plans
+typedef struct planCache_s {
+    size_t capacity;
+    std::mutex mtx;
+    std::list<std::shared_ptr<const plan_s>> lru;
+    std::unordered_map<uint64_t, std::list<std::shared_ptr<const plan_s>>::iterator> map;
+} planCache_s;
+
+planCache_s *planCacheDefault();
+
+// Cached plan of a configuration, built on a miss
+std::shared_ptr<const plan_s> planGet(planCache_s *cache, const polarCfg_s *cfg);
+
+// Same for raw params, validated with polarCfgInit first (throws when invalid)
+std::shared_ptr<const plan_s> planGet(planCache_s *cache, const params_s *params);
+
+#endif // PLAN_H_
@@ -0,0 +1,48 @@
+#ifndef POLAR_H_
+#define POLAR_H_
+
+#include "simd.h"
+#include <cstdint>
+
+// Header-only so the transforms inline into the encoders and decoders calling them
+
+// In-place polar transform x = u * F^{(x)n} with Arikan kernel F = [1 0; 1 1].
+// N must be a power of two. Uses N*log2(N)/2 XORs.
+inline void polarEnc(int *bits, int N) {
+    // Butterfly stages with stride 1, 2, 4, ..., N/2
+    for (int s = 1; s < N; s <<= 1) {
+        for (int i = 0; i < N; i += 2 * s) {
+            for (int j = i; j < i + s; ++j) {
+                bits[j] ^= bits[j + s];
+            }
+        }
+    }
+}
+
+// Butterfly stages with strides 1, 2, ..., min(32, N/2) inside one packed word, the
+// whole transform for N <= 64
+inline uint64_t polarEncWord(uint64_t x, int N) {
+    // Masks of the lower half of each 2s-bit block
+    constexpr uint64_t masks[6] = {0x5555555555555555ull, 0x3333333333333333ull,
+                                   0x0f0f0f0f0f0f0f0full, 0x00ff00ff00ff00ffull,
+                                   0x0000ffff0000ffffull, 0x00000000ffffffffull};
+    for (int k = 0, s = 1; k < 6 && s < N; ++k, s <<= 1)
+        x ^= (x >> s) & masks[k];
+    return x;
+}
+
+// Same transform on packed bits (bit i in word i / 64, LSB first). One word inline,
+// longer codes with the SIMD kernels of the running CPU: strides below 64 with masked
+// shifts inside a word, larger strides with whole-word XORs.
+inline void polarEncPacked(uint64_t *words, int N) {
+    if (N <= 64) {
+        words[0] = polarEncWord(words[0], N);
+        return;
+    }
+    const simdKernels_s *k = simdGet();
+    int nWords = N >> 6;
+    k->polarBits(words, nWords, N);
+    k->polarWords(words, nWords);
+}
+
+#endif // POLAR_H_
@@ -0,0 +1,99 @@
+#include "polarcfg.h"
+#include "crc.h"
+#include "pattern.h"
+#include "plan.h"
+#include "tvload.h"
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+
+namespace fs = std::filesystem;
+
+static void polarCfgFail(const std::string &what, int value, int expected) {
+    throw std::runtime_error("invalid code configuration: " + what + " = " +
+                             std::to_string(value) + ", expected " +
+                             std::to_string(expected));
+}
+
+void polarCfgInit(polarCfg_s *cfg, const params_s *params) {
+    const params_s *p = params;
+    bool ul = p->link == LINK_UL;
+
+    // Ranges first, the derivations below assume them
+    if (p->link != LINK_DL && !ul)
+        throw std::runtime_error("invalid code configuration: link = " +
+                                 std::to_string(p->link));
+    if (p->A < (ul ? 12 : 1) || p->A > (ul ? 1706 : PAT_K_IL_MAX - 24))
+        throw std::runtime_error("invalid code configuration: A = " +
+                                 std::to_string(p->A) + " out of range");
+    if (p->E < 1 || p->E > 0xffff)
+        throw std::runtime_error("invalid code configuration: E = " +
+                                 std::to_string(p->E) + " out of range");
+
+    // Everything else follows from A and E, at no more than rate 1 per block,
+    // parity check bits included
+    int C = ul ? patUciSeg(p->A, p->E) : 1;
+    int kRef = (p->A + C - 1) / C + (ul ? patUciCrc(p->A) : 24);
+    int nPC = ul ? patUciPc(kRef) : 0;
+    if (p->E / C < kRef + nPC)
+        throw std::runtime_error("invalid code configuration: E = " +
+                                 std::to_string(p->E) + " below K + nPC = " +
+                                 std::to_string(kRef + nPC));
+    params_s ref;
+    if (ul) {
+        planUlParams(p->A, p->E, &ref);
+    } else {
+        ref.P = 24;
+        ref.K = p->A + ref.P;
+        ref.N = 1 << patPolarN(ref.K, p->E, 9);
+    }
+    if (p->P != ref.P || !crcSelect(p->P))
+        polarCfgFail("P", p->P, ref.P);
+    if (p->K != ref.K)
+        polarCfgFail("K", p->K, ref.K);
+    if (p->N != ref.N)
+        polarCfgFail("N", p->N, ref.N);
+    if (p->N > PLAN_N_MAX || p->K > (ul ? PLAN_K_MAX : PAT_K_IL_MAX) || p->K > p->N)
+        throw std::runtime_error("invalid code configuration: K = " +
+                                 std::to_string(p->K) + ", N = " + std::to_string(p->N) +
+                                 " beyond the plan limits");
+
+    cfg->params = *p;
+    cfg->n = __builtin_ctz(p->N);
+    cfg->nSeg = C;
+    cfg->segE = p->E / cfg->nSeg;
+    cfg->rmMode = patRmMode(p->K, cfg->segE, p->N);
+    cfg->key = planKey(p);
+}
+
+void polarCfgMake(polarCfg_s *cfg, int A, int E, int link) {
+    params_s params;
+    if (link == LINK_UL) {
+        planUlParams(A, E, &params);
+    } else {
+        params.A = A;
+        params.P = 24;
+        params.K = A + params.P;
+        params.E = E;
+        params.N = 1 << patPolarN(params.K, E, 9);
+        params.link = link;
+    }
+    polarCfgInit(cfg, &params);
+}
+
+void polarCfgRead(fs::path dir, polarCfg_s *cfg) {
+    tvlArray_s text;
+    tvlRead(dir / "params.txt", &text);
+    if (text.n != 5 && text.n != 6)
+        throw std::runtime_error((dir / "params.txt").string() + ": " +
+                                 std::to_string(text.n) +
+                                 " values, expected A P K E N [link]");
+    params_s params;
+    params.A = tvlAt(&text, 0);
+    params.P = tvlAt(&text, 1);
+    params.K = tvlAt(&text, 2);
+    params.E = tvlAt(&text, 3);
+    params.N = tvlAt(&text, 4);
+    params.link = text.n > 5 ? tvlAt(&text, 5) : LINK_DL;
+    polarCfgInit(cfg, &params);
+}
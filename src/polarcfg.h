@@ -0,0 +1,63 @@
+#ifndef POLARCFG_H_
+#define POLARCFG_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+
+namespace fs = std::filesystem;
+
+// Link direction: DCI on PDCCH, or UCI with code block segmentation, parity check
+// bits and channel interleaving (6.3.1)
+typedef enum link_e { LINK_DL, LINK_UL } link_e;
+
+// For the uplink P, K and N are per code block and E is the total
+typedef struct params_s {
+    int A;
+    int P;
+    int K;
+    int E;
+    int N;
+    int link;
+} params_s;
+
+// Validated code configuration: params_s checked against 38.212 once, with the values
+// every stage derives from it. Plain value type, equal configurations have equal keys.
+typedef struct polarCfg_s {
+    params_s params; // A, P, K, E, N, link, consistent with each other
+    int n;           // log2 N
+    int rmMode;      // rmMode_e of the bit selection of one code block
+    int nSeg;        // Code blocks, 2 for segmented UCI
+    int segE;        // Rate matched bits per code block
+    uint64_t key;    // planKey of params, unique among valid configurations
+} polarCfg_s;
+
+// Check params and derive the rest. Throws naming the first inconsistent value: P of
+// an unsupported CRC, K other than A + P (downlink) or the 6.3.1 value (uplink), N
+// other than the 5.3.1 mother code size, sizes beyond the plan limits.
+void polarCfgInit(polarCfg_s *cfg, const params_s *params);
+
+// Configuration of an A bit payload rate matched to E bits, P, K and N derived as the
+// standard does: CRC24C and nMax = 9 for DCI, 6.3.1 for UCI
+void polarCfgMake(polarCfg_s *cfg, int A, int E, int link);
+
+// params.txt of a test vector directory: A P K E N and an optional link, any other
+// number of values throws
+void polarCfgRead(fs::path dir, polarCfg_s *cfg);
+
+inline bool operator==(const polarCfg_s &a, const polarCfg_s &b) {
+    return a.key == b.key;
+}
+inline bool operator!=(const polarCfg_s &a, const polarCfg_s &b) {
+    return a.key != b.key;
+}
+
+// Configurations as keys of unordered containers
+template <> struct std::hash<polarCfg_s> {
+    size_t operator()(const polarCfg_s &cfg) const {
+        return std::hash<uint64_t>()(cfg.key);
+    }
+};
+
+#endif // POLARCFG_H_
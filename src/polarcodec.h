@@ -0,0 +1,28 @@
+#ifndef POLARCODEC_H_
+#define POLARCODEC_H_
+
+// Public interface of the polar_codec library, none of it pulls in xtensor:
+//
+//   polarCfg_s cfg;                         // polarcfg.h
+//   polarCfgMake(&cfg, A, E, LINK_DL);      // Validated, throws otherwise
+//   auto plan = planGet(planCacheDefault(), &cfg);
+//   planEncode(plan.get(), info, rnti, rm); // plan.h, no allocation
+//
+//   dec_s dec;                              // decdl.h, one per thread
+//   decCreate(&dec, plan);
+//   bool ok = decDecode16(&dec, llr, DEC_L_MAX, rnti, info);
+//
+// polar.h and crc.h are header-only on the hot path, so the butterfly and the CRC
+// inline into the code calling them. The batch encoder (batch.h) and PDCCH blind
+// decoding (blind.h) build on the same plans.
+
+#include "batch.h"
+#include "bitvec.h"
+#include "blind.h"
+#include "crc.h"
+#include "decdl.h"
+#include "plan.h"
+#include "polar.h"
+#include "polarcfg.h"
+
+#endif // POLARCODEC_H_
@@ -0,0 +1,60 @@
+#include "pool.h"
+#include "prof.h"
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+int poolThreads(int nThreads) {
+    if (nThreads > 0)
+        return nThreads;
+    int n = std::thread::hardware_concurrency();
+    return n > 0 ? n : 1;
+}
+
+static bool poolPop(poolQueue_s *q, int *task, bool back) {
+    std::lock_guard<std::mutex> lock(q->mtx);
+    if (q->tasks.empty())
+        return false;
+    if (back) {
+        *task = q->tasks.back();
+        q->tasks.pop_back();
+    } else {
+        *task = q->tasks.front();
+        q->tasks.pop_front();
+    }
+    return true;
+}
+
+void poolRun(int nThreads, int nTasks, const std::function<void(int, int)> &fn) {
+    int n = poolThreads(nThreads);
+    std::vector<poolQueue_s> queues(n);
+    for (int t = 0; t < nTasks; ++t)
+        queues[t % n].tasks.push_back(t);
+
+    // No task is added while running, so a full round of failed steals means done
+    auto worker = [&](int w) {
+        if (profOn())
+            profThreadInit();
+        int task;
+        for (;;) {
+            if (poolPop(&queues[w], &task, true)) {
+                fn(task, w);
+                continue;
+            }
+            bool stolen = false;
+            for (int i = 1; i < n && !stolen; ++i)
+                stolen = poolPop(&queues[(w + i) % n], &task, false);
+            if (!stolen)
+                return;
+            fn(task, w);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int w = 1; w < n; ++w)
+        threads.emplace_back(worker, w);
+    worker(0);
+    for (std::thread &t : threads)
+        t.join();
+}
@@ -0,0 +1,24 @@
+#ifndef POOL_H_
+#define POOL_H_
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// Work-stealing pool over task indices. Tasks are dealt round-robin to per-worker
+// deques, a worker pops its own tasks LIFO and steals FIFO from the others when it
+// runs dry.
+typedef struct poolQueue_s {
+    std::mutex mtx;
+    std::deque<int> tasks;
+} poolQueue_s;
+
+// Run fn(task, worker) for tasks 0..nTasks-1 on nThreads threads (0 = hardware
+// concurrency) and wait for all of them
+void poolRun(int nThreads, int nTasks, const std::function<void(int, int)> &fn);
+
+// Worker count poolRun uses for nThreads
+int poolThreads(int nThreads);
+
+#endif // POOL_H_
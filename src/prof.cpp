@@ -0,0 +1,185 @@
+#include "prof.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+static const char *profStageNames[PROF_N_STAGES] = {
+    "crc", "scr", "intrl", "frozen", "enc", "rm", "ofdm", "encode",
+};
+
+// Tick to time calibration base, taken when profiling is switched on; steady clock ns.
+// Written by profSet while other threads may read it in profStats.
+static std::atomic<uint64_t> profBaseTicks;
+static std::atomic<int64_t> profBaseNs;
+
+// Histograms of all threads that recorded, kept after the threads exit
+static std::mutex profMtx;
+static std::vector<std::unique_ptr<profHist_s>> profHists;
+static thread_local profHist_s *profHist = nullptr;
+
+static int64_t profNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+static void profSetBase() {
+    profBaseTicks.store(profTicks(), std::memory_order_relaxed);
+    profBaseNs.store(profNowNs(), std::memory_order_relaxed);
+}
+
+static bool profInit() {
+    const char *s = std::getenv("XT_PROF");
+    bool on = s && *s && *s != '0';
+    profSetBase();
+    if (on)
+        profThreadInit();
+    return on;
+}
+
+std::atomic<bool> profEnabled{profInit()};
+
+void profSet(bool on) {
+    if (on && !profOn())
+        profSetBase();
+    if (on)
+        profThreadInit();
+    profEnabled.store(on, std::memory_order_relaxed);
+}
+
+const char *profStageName(int stage) { return profStageNames[stage]; }
+
+static int profBucket(uint64_t ticks) {
+    if (ticks < (1 << PROF_SUB_BITS))
+        return int(ticks);
+    int msb = 63 - __builtin_clzll(ticks);
+    int sub = int(ticks >> (msb - PROF_SUB_BITS)) & ((1 << PROF_SUB_BITS) - 1);
+    return ((msb - PROF_SUB_BITS + 1) << PROF_SUB_BITS) | sub;
+}
+
+// Middle of bucket b in ticks
+static double profBucketMid(int b) {
+    if (b < (1 << PROF_SUB_BITS))
+        return b;
+    int msb = (b >> PROF_SUB_BITS) + PROF_SUB_BITS - 1;
+    int sub = b & ((1 << PROF_SUB_BITS) - 1);
+    double lo = double(uint64_t((1 << PROF_SUB_BITS) | sub) << (msb - PROF_SUB_BITS));
+    return lo + double(uint64_t{1} << (msb - PROF_SUB_BITS)) / 2;
+}
+
+static void profClear(profHist_s *h) {
+    for (int s = 0; s < PROF_N_STAGES; ++s) {
+        for (auto &n : h->n[s])
+            n.store(0, std::memory_order_relaxed);
+        h->sum[s].store(0, std::memory_order_relaxed);
+        h->max[s].store(0, std::memory_order_relaxed);
+    }
+}
+
+void profThreadInit() {
+    if (profHist)
+        return;
+    auto h = std::make_unique<profHist_s>();
+    profClear(h.get());
+    profHist = h.get();
+    std::lock_guard<std::mutex> lock(profMtx);
+    profHists.push_back(std::move(h));
+}
+
+void profRecord(int stage, uint64_t ticks) {
+    if (__builtin_expect(!profHist, 0))
+        profThreadInit();
+    profHist_s *h = profHist;
+    auto inc = [](std::atomic<uint64_t> &a, uint64_t v) {
+        a.store(a.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+    };
+    inc(h->n[stage][profBucket(ticks)], 1);
+    inc(h->sum[stage], ticks);
+    if (ticks > h->max[stage].load(std::memory_order_relaxed))
+        h->max[stage].store(ticks, std::memory_order_relaxed);
+}
+
+// ns per tick from the ticks and the steady clock since profiling was switched on
+static double profNsPerTick() {
+    const int64_t minSpanNs = 10000000;
+    int64_t baseNs = profBaseNs.load(std::memory_order_relaxed);
+    uint64_t baseTicks = profBaseTicks.load(std::memory_order_relaxed);
+    int64_t span = profNowNs() - baseNs;
+    if (span < minSpanNs)
+        std::this_thread::sleep_for(std::chrono::nanoseconds(minSpanNs - span));
+    uint64_t ticks = profTicks() - baseTicks;
+    double ns = double(profNowNs() - baseNs);
+    return ticks ? ns / ticks : 1.0;
+}
+
+static void profMerge(int stage, uint64_t *n, uint64_t *sum, uint64_t *max) {
+    std::lock_guard<std::mutex> lock(profMtx);
+    for (const auto &h : profHists) {
+        for (int b = 0; b < PROF_N_BUCKETS; ++b)
+            n[b] += h->n[stage][b].load(std::memory_order_relaxed);
+        *sum += h->sum[stage].load(std::memory_order_relaxed);
+        *max = std::max(*max, h->max[stage].load(std::memory_order_relaxed));
+    }
+}
+
+static void profStatsScaled(int stage, double nsPerTick, profStats_s *stats) {
+    uint64_t n[PROF_N_BUCKETS] = {}, sum = 0, max = 0;
+    profMerge(stage, n, &sum, &max);
+
+    // Count and mean
+    uint64_t count = 0;
+    for (uint64_t c : n)
+        count += c;
+    *stats = {count, 0, 0, 0, 0, max * nsPerTick};
+    if (!count)
+        return;
+    stats->meanNs = double(sum) / count * nsPerTick;
+
+    // Quantiles, the bucket holding the nearest rank ceil(q * count)
+    const double q[3] = {0.5, 0.99, 0.999};
+    double *out[3] = {&stats->p50Ns, &stats->p99Ns, &stats->p999Ns};
+    for (int i = 0; i < 3; ++i) {
+        uint64_t rank = std::max<uint64_t>(1, uint64_t(std::ceil(q[i] * count - 1e-9)));
+        uint64_t cum = 0;
+        int b = 0;
+        while ((cum += n[b]) < rank)
+            ++b;
+        *out[i] = std::min(profBucketMid(b), double(max)) * nsPerTick;
+    }
+}
+
+void profStats(int stage, profStats_s *stats) {
+    profStatsScaled(stage, profNsPerTick(), stats);
+}
+
+void profDump(std::ostream &os) {
+    double nsPerTick = profNsPerTick();
+    char line[128];
+    std::snprintf(line, sizeof(line), "%-8s %10s %10s %10s %10s %10s %10s", "stage",
+                  "count", "mean ns", "p50 ns", "p99 ns", "p99.9 ns", "max ns");
+    os << line << std::endl;
+    for (int s = 0; s < PROF_N_STAGES; ++s) {
+        profStats_s st;
+        profStatsScaled(s, nsPerTick, &st);
+        if (!st.count)
+            continue;
+        std::snprintf(line, sizeof(line),
+                      "%-8s %10llu %10.1f %10.1f %10.1f %10.1f %10.1f", profStageNames[s],
+                      (unsigned long long)st.count, st.meanNs, st.p50Ns, st.p99Ns,
+                      st.p999Ns, st.maxNs);
+        os << line << std::endl;
+    }
+}
+
+void profReset() {
+    std::lock_guard<std::mutex> lock(profMtx);
+    for (const auto &h : profHists)
+        profClear(h.get());
+}
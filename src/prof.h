@@ -0,0 +1,101 @@
+#ifndef PROF_H_
+#define PROF_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Stage latency profiling with time stamp counter timers and per-thread log-linear
+// histograms. Off by default, XT_PROF=1 in the environment or profSet turns it on.
+// When off a timer costs a relaxed load and well predicted branches, no counter read.
+
+typedef enum profStage_e {
+    PROF_CRC,
+    PROF_SCRAMBLE,
+    PROF_INTRL,
+    PROF_FROZEN,
+    PROF_ENC,
+    PROF_RM,
+    PROF_OFDM,   // QPSK, resource mapping and IFFT of a slot
+    PROF_ENCODE, // Whole planEncode
+    PROF_N_STAGES,
+} profStage_e;
+
+// 8 sub-buckets per power of two of ticks, 12.5 % resolution
+#define PROF_SUB_BITS 3
+#define PROF_N_BUCKETS (64 << PROF_SUB_BITS)
+
+// Histograms of one thread. Only the owning thread writes, so updates are plain
+// relaxed load + store, readers may see a slightly stale count.
+typedef struct profHist_s {
+    std::atomic<uint64_t> n[PROF_N_STAGES][PROF_N_BUCKETS];
+    std::atomic<uint64_t> sum[PROF_N_STAGES]; // Ticks
+    std::atomic<uint64_t> max[PROF_N_STAGES];
+} profHist_s;
+
+typedef struct profStats_s {
+    uint64_t count;
+    double meanNs;
+    double p50Ns;
+    double p99Ns;
+    double p999Ns;
+    double maxNs;
+} profStats_s;
+
+extern std::atomic<bool> profEnabled;
+
+inline bool profOn() { return profEnabled.load(std::memory_order_relaxed); }
+void profSet(bool on);
+
+inline uint64_t profTicks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t t;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(t));
+    return t;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+}
+
+// Allocate the histogram of the calling thread, so its first sample does not. profSet
+// does it for the caller and poolRun workers when they start with profiling on; other
+// threads call it before their timed loops. Threads that did not call it allocate
+// their histogram on their first sample.
+void profThreadInit();
+
+// Add one sample of ticks to the histogram of the calling thread
+void profRecord(int stage, uint64_t ticks);
+
+// Statistics of a stage over all threads, in ns
+void profStats(int stage, profStats_s *stats);
+
+// Table of all stages with samples. Call with the instrumented threads idle.
+void profDump(std::ostream &os);
+void profReset();
+
+const char *profStageName(int stage);
+
+// Timer of one stage, records on stop() or when going out of scope
+typedef struct profTimer_s {
+    int stage;
+    uint64_t t0; // 0 when profiling is off or already stopped
+
+    explicit profTimer_s(int s) : stage(s), t0(profOn() ? profTicks() : 0) {}
+    ~profTimer_s() { stop(); }
+    void stop() {
+        if (t0) {
+            profRecord(stage, profTicks() - t0);
+            t0 = 0;
+        }
+    }
+} profTimer_s;
+
+#endif // PROF_H_
@@ -0,0 +1,76 @@
+#include "ratematch.h"
+#include "pattern.h"
+#include <cstdint>
+
+// Bits [src, src + len) of d, len <= 32
+static inline uint64_t rmField(const uint64_t *d, int src, int len) {
+    int w = src >> 6, sh = src & 63;
+    uint64_t v = d[w] >> sh;
+    if (sh + len > 64)
+        v |= d[w + 1] << (64 - sh);
+    return v & ((uint64_t{1} << len) - 1);
+}
+
+void rmStreamPacked(const rmStream_s *rm, const uint64_t *d, uint64_t *e) {
+    uint64_t acc = 0;
+    int fill = 0;
+
+    // Channel interleaved, one bit at a time through the triangle
+    if (rm->T) {
+        for (int j = 0; j < rm->T; ++j)
+            for (int i = 0; i < rm->T - j; ++i) {
+                int k = i * rm->T - i * (i - 1) / 2 + j;
+                if (k >= rm->E)
+                    continue;
+                int src = rmSource(rm, k);
+                acc |= ((d[src >> 6] >> (src & 63)) & 1) << fill;
+                if (++fill == 64) {
+                    *e++ = acc;
+                    acc = 0;
+                    fill = 0;
+                }
+            }
+        if (fill)
+            *e = acc;
+        return;
+    }
+
+    // Runs of whole sub-blocks when the selection starts on a sub-block (always but
+    // for some puncturing): B divides 64, so no field or output word is straddled
+    int lgB = __builtin_ctz(rm->N) - 5, B = 1 << lgB;
+    if ((rm->start & (B - 1)) == 0) {
+        uint64_t mask = B == 64 ? ~uint64_t{0} : (uint64_t{1} << B) - 1;
+        int blk = rm->start >> lgB;
+        for (int k = 0; k < rm->E; k += B) {
+            int src = PAT_SUB_BLOCK[blk] << lgB;
+            acc |= ((d[src >> 6] >> (src & 63)) & mask) << fill;
+            fill += B;
+            if (fill == 64) {
+                *e++ = acc;
+                acc = 0;
+                fill = 0;
+            }
+            blk = (blk + 1) & 31;
+        }
+        // Bits past E of the last run
+        if (int tail = rm->E & 63)
+            (fill ? acc : e[-1]) &= (uint64_t{1} << tail) - 1;
+        if (fill)
+            *e = acc;
+        return;
+    }
+
+    // Runs appended to a word accumulator, full words go out as they complete
+    rmRuns(rm, [&](int, int src, int len) {
+        uint64_t v = rmField(d, src, len);
+        acc |= v << fill;
+        fill += len;
+        if (fill >= 64) {
+            *e++ = acc;
+            fill -= 64;
+            acc = fill ? v >> (len - fill) : 0;
+        }
+    });
+    if (fill)
+        *e = acc;
+}
@@ -0,0 +1,70 @@
+#ifndef RATEMATCH_H_
+#define RATEMATCH_H_
+
+#include "pattern.h"
+#include <algorithm>
+#include <cstdint>
+
+// Streaming rate matching, 38.212 5.4.1. Sub-block interleaving, bit selection from
+// the circular buffer and the optional triangular channel interleaver are generated
+// on the fly, no E-length pattern is stored. Without the channel interleaver the
+// output is a sequence of runs of up to N/32 consecutive encoded bits, each copied
+// as one bit field straight into the caller's buffer.
+typedef struct rmStream_s {
+    int N;
+    int E;
+    int start; // Circular buffer position of output bit 0, N - E when puncturing
+    int T;     // Channel interleaver side, 0 without it
+} rmStream_s;
+
+// Stream for K info + CRC bits, channel interleaved when bil (uplink, I_BIL = 1)
+constexpr void rmStreamInit(rmStream_s *rm, int K, int E, int N, bool bil = false) {
+    rm->N = N;
+    rm->E = E;
+    rm->start = patRmMode(K, E, N) == RM_PUNCTURING ? N - E : 0;
+
+    // Smallest T with T (T + 1) / 2 >= E
+    rm->T = 0;
+    if (bil)
+        while (rm->T * (rm->T + 1) / 2 < E)
+            ++rm->T;
+}
+
+// Encoded bit of output bit k before channel interleaving
+inline int rmSource(const rmStream_s *rm, int k) {
+    return patSubBlock((rm->start + k) % rm->N, rm->N);
+}
+
+// Calls emit(k, src, len) for the runs e[k, k + len) = d[src, src + len) of the bit
+// selection output, in order
+template <class F> inline void rmRuns(const rmStream_s *rm, F &&emit) {
+    int lgB = __builtin_ctz(rm->N) - 5, B = 1 << lgB, n = rm->start;
+    for (int k = 0; k < rm->E;) {
+        int o = n & (B - 1), len = std::min(B - o, rm->E - k);
+        emit(k, (PAT_SUB_BLOCK[n >> lgB] << lgB) + o, len);
+        k += len;
+        n += len;
+        if (n == rm->N)
+            n = 0;
+    }
+}
+
+// Rate match N packed encoded bits d into bvWords(E) packed words of e
+void rmStreamPacked(const rmStream_s *rm, const uint64_t *d, uint64_t *e);
+
+// Same on one value per bit, e.g. the int arrays of the reference chain
+template <class T> void rmStreamBits(const rmStream_s *rm, const T *d, T *e) {
+    if (rm->T) {
+        // Column-wise read of the row-wise filled triangle, rows i of T - i bits
+        int f = 0;
+        for (int j = 0; j < rm->T; ++j)
+            for (int i = 0; i < rm->T - j; ++i)
+                if (int k = i * rm->T - i * (i - 1) / 2 + j; k < rm->E)
+                    e[f++] = d[rmSource(rm, k)];
+        return;
+    }
+    rmRuns(rm,
+           [&](int k, int src, int len) { std::copy(d + src, d + src + len, e + k); });
+}
+
+#endif // RATEMATCH_H_
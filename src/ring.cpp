@@ -0,0 +1,94 @@
+#include "ring.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fcntl.h>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+
+size_t ringBytes(int nSlots, int slotBytes) {
+    return sizeof(ringHdr_s) + size_t(nSlots) * (RING_LINE + slotBytes);
+}
+
+// Map bytes of the named object, or anonymous memory without a name
+static void *ringMap(const char *name, size_t bytes, bool create) {
+    int fd = -1;
+    if (name) {
+        fd = shm_open(name, create ? O_RDWR | O_CREAT | O_TRUNC : O_RDWR, 0600);
+        if (fd < 0)
+            throw std::runtime_error(std::string("cannot open shared memory ") + name);
+        if (create && ftruncate(fd, bytes) != 0) {
+            close(fd);
+            throw std::runtime_error(std::string("cannot size shared memory ") + name);
+        }
+    }
+    void *mem = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                     name ? MAP_SHARED : MAP_SHARED | MAP_ANONYMOUS, fd, 0);
+    if (fd >= 0)
+        close(fd);
+    if (mem == MAP_FAILED)
+        throw std::runtime_error("cannot map ring");
+    return mem;
+}
+
+static void ringSetup(ring_s *ring, void *mem, size_t bytes) {
+    ring->hdr = static_cast<ringHdr_s *>(mem);
+    ring->slots = static_cast<uint8_t *>(mem) + sizeof(ringHdr_s);
+    ring->mask = ring->hdr->nSlots - 1;
+    ring->stride = RING_LINE + ring->hdr->slotBytes;
+    ring->mapBytes = bytes;
+}
+
+void ringCreate(ring_s *ring, const char *name, int nSlots, int slotBytes,
+                unsigned flags) {
+    if (nSlots < 1 || slotBytes < 1)
+        throw std::runtime_error("empty ring");
+    uint32_t n = 1;
+    while (n < uint32_t(nSlots))
+        n <<= 1;
+    slotBytes = (slotBytes + RING_LINE - 1) / RING_LINE * RING_LINE;
+
+    size_t bytes = ringBytes(n, slotBytes);
+    void *mem = ringMap(name, bytes, true);
+    ringHdr_s *h = new (mem) ringHdr_s;
+    h->nSlots = n;
+    h->slotBytes = slotBytes;
+    h->flags = flags;
+    h->tail.store(0, std::memory_order_relaxed);
+    h->head.store(0, std::memory_order_relaxed);
+    ringSetup(ring, mem, bytes);
+    for (uint64_t i = 0; i < n; ++i)
+        new (ringSeq(ring, i)) std::atomic<uint64_t>(i);
+
+    // Attaching processes check the magic last
+    std::atomic_thread_fence(std::memory_order_release);
+    h->magic = RING_MAGIC;
+    ring->name = name ? name : "";
+    ring->owner = true;
+}
+
+void ringAttach(ring_s *ring, const char *name) {
+    // Header first for the size, then the whole ring
+    auto *h = static_cast<ringHdr_s *>(ringMap(name, sizeof(ringHdr_s), false));
+    bool ok = h->magic == RING_MAGIC && h->nSlots && !(h->nSlots & (h->nSlots - 1));
+    size_t bytes = ringBytes(h->nSlots, h->slotBytes);
+    munmap(h, sizeof(ringHdr_s));
+    if (!ok)
+        throw std::runtime_error(std::string("not a ring: ") + name);
+    ringSetup(ring, ringMap(name, bytes, false), bytes);
+    ring->name = name;
+    ring->owner = false;
+}
+
+void ringClose(ring_s *ring) {
+    if (!ring->hdr)
+        return;
+    munmap(ring->hdr, ring->mapBytes);
+    if (ring->owner && !ring->name.empty())
+        shm_unlink(ring->name.c_str());
+    ring->hdr = nullptr;
+    ring->slots = nullptr;
+}
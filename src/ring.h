@@ -0,0 +1,126 @@
+#ifndef RING_H_
+#define RING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Bounded lock-free ring of fixed size slots (Vyukov's MPMC queue), in process memory
+// or in a POSIX shared memory object another process attaches to. Slots are used in
+// place: a producer claims a slot, writes the payload and publishes it, a consumer
+// acquires it, reads and releases it, so nothing is copied through the ring. A full
+// ring makes ringClaim fail, which is the backpressure to the producer.
+
+#define RING_MAGIC 0x31474e4952585478ull // "xTXRING1"
+
+// Single producer / consumer sides skip the compare-and-swap on their index
+#define RING_SP 1
+#define RING_SC 2
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "ring needs 64-bit atomics");
+
+// Shared header, the slots follow it. Each slot is a line with its sequence number
+// followed by slotBytes of payload, so payloads are 64-byte aligned. The indices are
+// on lines of their own so producers and consumers do not share one.
+#define RING_LINE 64
+typedef struct ringHdr_s {
+    uint64_t magic;
+    uint32_t nSlots; // Power of 2
+    uint32_t slotBytes;
+    uint32_t flags;
+    alignas(RING_LINE) std::atomic<uint64_t> tail; // Next position to claim
+    alignas(RING_LINE) std::atomic<uint64_t> head; // Next position to acquire
+} ringHdr_s;
+
+typedef struct ring_s {
+    ringHdr_s *hdr;
+    uint8_t *slots;
+    uint64_t mask;
+    size_t stride; // RING_LINE + slotBytes
+    size_t mapBytes;
+    std::string name; // Shared memory object, empty for process memory
+    bool owner;       // Unlinks the object on close
+} ring_s;
+
+// Bytes of a ring, header included
+size_t ringBytes(int nSlots, int slotBytes);
+
+// New ring of nSlots (rounded up to a power of 2) with slotBytes (rounded up to 64)
+// per slot. name is a shared memory object name like "/xt_ex.req", created or
+// truncated, or nullptr for process memory.
+void ringCreate(ring_s *ring, const char *name, int nSlots, int slotBytes,
+                unsigned flags = 0);
+
+// Map a ring another process created
+void ringAttach(ring_s *ring, const char *name);
+
+void ringClose(ring_s *ring);
+
+inline std::atomic<uint64_t> *ringSeq(const ring_s *ring, uint64_t pos) {
+    return reinterpret_cast<std::atomic<uint64_t> *>(ring->slots +
+                                                     (pos & ring->mask) * ring->stride);
+}
+
+inline void *ringPayload(const ring_s *ring, uint64_t pos) {
+    return ring->slots + (pos & ring->mask) * ring->stride + RING_LINE;
+}
+
+// Slot of the next position for writing, nullptr when the ring is full. On success
+// *pos is the position to publish.
+inline void *ringClaim(ring_s *ring, uint64_t *pos) {
+    ringHdr_s *h = ring->hdr;
+    uint64_t p = h->tail.load(std::memory_order_relaxed);
+    for (;;) {
+        int64_t dif = int64_t(ringSeq(ring, p)->load(std::memory_order_acquire) - p);
+        if (dif < 0)
+            return nullptr;
+        if (dif == 0) {
+            if (h->flags & RING_SP) {
+                h->tail.store(p + 1, std::memory_order_relaxed);
+                break;
+            }
+            if (h->tail.compare_exchange_weak(p, p + 1, std::memory_order_relaxed))
+                break;
+        } else {
+            p = h->tail.load(std::memory_order_relaxed);
+        }
+    }
+    *pos = p;
+    return ringPayload(ring, p);
+}
+
+inline void ringPublish(ring_s *ring, uint64_t pos) {
+    ringSeq(ring, pos)->store(pos + 1, std::memory_order_release);
+}
+
+// Slot of the oldest published position, nullptr when the ring is empty
+inline void *ringAcquire(ring_s *ring, uint64_t *pos) {
+    ringHdr_s *h = ring->hdr;
+    uint64_t p = h->head.load(std::memory_order_relaxed);
+    for (;;) {
+        uint64_t seq = ringSeq(ring, p)->load(std::memory_order_acquire);
+        int64_t dif = int64_t(seq - (p + 1));
+        if (dif < 0)
+            return nullptr;
+        if (dif == 0) {
+            if (h->flags & RING_SC) {
+                h->head.store(p + 1, std::memory_order_relaxed);
+                break;
+            }
+            if (h->head.compare_exchange_weak(p, p + 1, std::memory_order_relaxed))
+                break;
+        } else {
+            p = h->head.load(std::memory_order_relaxed);
+        }
+    }
+    *pos = p;
+    return ringPayload(ring, p);
+}
+
+// Hand the slot back to the producers
+inline void ringRelease(ring_s *ring, uint64_t pos) {
+    ringSeq(ring, pos)->store(pos + ring->mask + 1, std::memory_order_release);
+}
+
+#endif // RING_H_
@@ -0,0 +1,165 @@
+#include "runner.h"
+#include "bitvec.h"
+#include "encdl.h"
+#include "plan.h"
+#include "polarcfg.h"
+#include "pool.h"
+#include "prof.h"
+#include "tvload.h"
+#include "util.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Wildcard match of * and ? on a file name
+static bool runMatch(const char *pat, const char *s) {
+    if (*pat == '\0')
+        return *s == '\0';
+    if (*pat == '*')
+        return runMatch(pat + 1, s) || (*s && runMatch(pat, s + 1));
+    return *s && (*pat == '?' || *pat == *s) && runMatch(pat + 1, s + 1);
+}
+
+static void runAdd(const fs::path &path, std::vector<fs::path> *dirs) {
+    if (fs::is_directory(path) && fs::exists(path / "params.txt")) {
+        dirs->push_back(path);
+    } else if (fs::is_directory(path)) {
+        std::vector<fs::path> sub;
+        for (const auto &it : fs::directory_iterator(path))
+            if (it.is_directory() && fs::exists(it.path() / "params.txt"))
+                sub.push_back(it.path());
+        std::sort(sub.begin(), sub.end());
+        dirs->insert(dirs->end(), sub.begin(), sub.end());
+    } else if (fs::is_regular_file(path)) {
+        // Manifest, paths relative to the manifest directory
+        std::ifstream in(path);
+        std::string line;
+        while (std::getline(in, line))
+            if (!line.empty() && line[0] != '#')
+                runAdd(path.parent_path() / line, dirs);
+    } else {
+        std::string name = path.filename().string();
+        fs::path parent = path.has_parent_path() ? path.parent_path() : fs::path(".");
+        if (name.find_first_of("*?") == std::string::npos || !fs::is_directory(parent))
+            return;
+        std::vector<fs::path> sub;
+        for (const auto &it : fs::directory_iterator(parent))
+            if (runMatch(name.c_str(), it.path().filename().string().c_str()))
+                sub.push_back(it.path());
+        std::sort(sub.begin(), sub.end());
+        for (const fs::path &p : sub)
+            runAdd(p, dirs);
+    }
+}
+
+std::vector<fs::path> runFind(const std::vector<std::string> &args) {
+    std::vector<fs::path> dirs;
+    for (const std::string &a : args)
+        runAdd(fs::path(a), &dirs);
+    return dirs;
+}
+
+// Per worker totals, summed after the run. A cache line each, workers updating
+// neighbouring entries do not share lines.
+typedef struct alignas(64) runStats_s {
+    int64_t nVectors;
+    int64_t nErrors;
+    int64_t nFailed;
+    int64_t nDiffBits;
+    int64_t nBits;
+    double loadNs;
+    double encNs;
+} runStats_s;
+
+static void runOne(const fs::path &dir, runStats_s *stats) {
+    // Read params, info, RNTI (MSB first) and reference rate matched bits, packed as
+    // they are parsed. Only the files used are read.
+    auto t0 = std::chrono::steady_clock::now();
+    polarCfg_s cfg;
+    polarCfgRead(dir, &cfg);
+    const params_s &params = cfg.params;
+    std::shared_ptr<const plan_s> plan = planGet(planCacheDefault(), &cfg);
+    tvl_s tvl;
+    tvlOpen(&tvl, dir);
+    std::shared_ptr<const tvlArray_s> info = tvlGet(&tvl, "info_bits");
+    std::shared_ptr<const tvlArray_s> rntiBits = tvlGet(&tvl, "rnti_bits");
+    std::shared_ptr<const tvlArray_s> rmRefs = tvlGet(&tvl, "rm_bits");
+    if (!info->bits || info->n != params.A || !rmRefs->bits || rmRefs->n != params.E)
+        throw std::runtime_error("info or rate matched bits do not match params");
+    uint16_t rnti = 0;
+    for (int64_t i = 0; i < rntiBits->n; ++i)
+        rnti = (rnti << 1) | tvlAt(rntiBits.get(), i);
+    tvlClose(&tvl);
+
+    // Encode, timed apart from loading
+    bitvec_s rm;
+    bvInit(&rm, params.E);
+    auto t1 = std::chrono::steady_clock::now();
+    {
+        profTimer_s timer(PROF_ENCODE);
+        planEncode(plan.get(), info->words.data(), rnti, rm.words.data());
+    }
+    auto t2 = std::chrono::steady_clock::now();
+
+    int nDiffBits = 0;
+    for (size_t w = 0; w < rm.words.size(); ++w)
+        nDiffBits += __builtin_popcountll(rm.words[w] ^ rmRefs->words[w]);
+    stats->nVectors += 1;
+    stats->nFailed += nDiffBits > 0;
+    stats->nDiffBits += nDiffBits;
+    stats->nBits += params.E;
+    stats->loadNs += std::chrono::duration<double, std::nano>(t1 - t0).count();
+    stats->encNs += std::chrono::duration<double, std::nano>(t2 - t1).count();
+}
+
+void runTvs(const std::vector<fs::path> &dirs, int nThreads) {
+    int n = poolThreads(nThreads);
+    std::vector<runStats_s> stats(n, runStats_s{});
+    std::mutex errMtx;
+
+    auto t0 = std::chrono::steady_clock::now();
+    poolRun(n, dirs.size(), [&](int task, int worker) {
+        try {
+            runOne(dirs[task], &stats[worker]);
+        } catch (const std::exception &e) {
+            stats[worker].nErrors += 1;
+            std::lock_guard<std::mutex> lock(errMtx);
+            std::cerr << dirs[task].string() << ": " << e.what() << std::endl;
+        }
+    });
+    auto t1 = std::chrono::steady_clock::now();
+
+    runStats_s sum = {};
+    for (const runStats_s &s : stats) {
+        sum.nVectors += s.nVectors;
+        sum.nErrors += s.nErrors;
+        sum.nFailed += s.nFailed;
+        sum.nDiffBits += s.nDiffBits;
+        sum.nBits += s.nBits;
+        sum.loadNs += s.loadNs;
+        sum.encNs += s.encNs;
+    }
+    double wallS = std::chrono::duration<double>(t1 - t0).count();
+    std::cout << "nVectors: " << sum.nVectors << ", nErrors: " << sum.nErrors
+              << ", nFailed: " << sum.nFailed << ", nDiffBits: " << sum.nDiffBits
+              << std::endl;
+    std::cout << "threads: " << n << ", wall: " << wallS * 1e3 << " ms, "
+              << sum.nVectors / wallS << " vectors/s, "
+              << (sum.nVectors ? sum.encNs / sum.nVectors : 0.0) << " ns/encode, "
+              << (sum.encNs > 0 ? sum.nBits / sum.encNs * 1e3 : 0.0) << " Mbit/s encoded"
+              << std::endl;
+    std::cout << "load: " << sum.loadNs * 1e-6 << " ms over all threads, "
+              << (sum.nVectors ? sum.loadNs / sum.nVectors * 1e-3 : 0.0) << " us/vector"
+              << std::endl;
+}
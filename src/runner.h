@@ -0,0 +1,20 @@
+#ifndef RUNNER_H_
+#define RUNNER_H_
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Test vector directories named by args: a directory with params.txt, a directory of
+// such directories, a manifest file with one path per line, or a path whose last
+// component has * / ? wildcards
+std::vector<fs::path> runFind(const std::vector<std::string> &args);
+
+// Encode and check all test vectors on a work-stealing pool of nThreads (0 = all
+// cores), plans shared through the plan cache, then print the aggregate nDiffBits and
+// throughput
+void runTvs(const std::vector<fs::path> &dirs, int nThreads = 0);
+
+#endif // RUNNER_H_
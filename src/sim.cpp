@@ -0,0 +1,190 @@
+#include "sim.h"
+#include "awgn.h"
+#include "bitvec.h"
+#include "decdl.h"
+#include "ofdm.h"
+#include "plan.h"
+#include "pool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+// Blocks per pool task, the granularity of early stopping
+#define SIM_BATCH 32
+
+// Decoder input: LLR * 16, saturated
+#define SIM_LLR_SCALE 16.0f
+#define SIM_LLR_MAX 4095
+
+// Scratch of one worker, the decoder is single threaded
+typedef struct simWorker_s {
+    dec_s dec;
+    std::vector<uint64_t> info;
+    std::vector<uint64_t> infoDec;
+    std::vector<uint64_t> rm;
+    std::vector<float> noise;
+    std::vector<std::complex<float>> sym;
+    std::vector<int16_t> llr;
+} simWorker_s;
+
+// Totals of one point, added once per batch
+typedef struct simCount_s {
+    std::atomic<int64_t> nBlocks;
+    std::atomic<int64_t> nBlockErrors;
+    std::atomic<int64_t> nUndetected;
+    std::atomic<int64_t> nBitErrors;
+} simCount_s;
+
+// splitmix64 step, the payload bits of a block
+static inline uint64_t simMix(uint64_t *s) {
+    uint64_t z = (*s += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+static inline int16_t simQuant(float llr) {
+    float q = std::nearbyint(llr * SIM_LLR_SCALE);
+    return int16_t(std::min<float>(std::max<float>(q, -SIM_LLR_MAX), SIM_LLR_MAX));
+}
+
+void simDefaults(simCfg_s *cfg) {
+    cfg->ebN0Db.clear();
+    for (int i = 0; i <= 12; ++i)
+        cfg->ebN0Db.push_back(0.5 * i);
+    cfg->L = DEC_L_MAX;
+    cfg->mod = SIM_BPSK;
+    cfg->maxBlocks = 100000;
+    cfg->targetErrors = 100;
+    cfg->nThreads = 0;
+    cfg->seed = 0x5eed;
+}
+
+// One block: encode, modulate, add noise, decode. Returns the info bit errors.
+static int simBlock(const simCfg_s *cfg, const plan_s *plan, int point, int64_t block,
+                    float sigma, simWorker_s *w, bool *crcOk) {
+    const params_s *p = &plan->params;
+    uint64_t id = (uint64_t(point) << 40) | uint64_t(block);
+
+    // Payload and RNTI
+    uint64_t mix = cfg->seed ^ (id * 0xd1342543de82ef95ull);
+    int nInfo = bvWords(p->A);
+    for (int i = 0; i < nInfo; ++i)
+        w->info[i] = simMix(&mix);
+    if (p->A & 63)
+        w->info[nInfo - 1] &= (uint64_t{1} << (p->A & 63)) - 1;
+    uint16_t rnti = uint16_t(simMix(&mix));
+
+    // Encoding
+    planEncode(plan, w->info.data(), rnti, w->rm.data());
+
+    // Modulation, noise and LLRs, positive for bit 0
+    awgn_s awgn;
+    awgnInit(&awgn, cfg->seed, id);
+    float s2 = sigma * sigma;
+    if (cfg->mod == SIM_QPSK) {
+        int nSym = (p->E + 1) / 2;
+        ofdmQpsk(w->rm.data(), p->E, w->sym.data());
+        awgnAdd(&awgn, w->sym.data(), w->sym.data(), nSym, sigma);
+        float g = 2.0f * 0.70710678f / s2;
+        for (int e = 0; e < p->E; ++e) {
+            std::complex<float> y = w->sym[e >> 1];
+            w->llr[e] = simQuant(g * (e & 1 ? y.imag() : y.real()));
+        }
+    } else {
+        awgnReal(&awgn, w->noise.data(), p->E, sigma);
+        float g = 2.0f / s2;
+        for (int e = 0; e < p->E; ++e) {
+            float x = 1.0f - 2.0f * float((w->rm[e >> 6] >> (e & 63)) & 1);
+            w->llr[e] = simQuant(g * (x + w->noise[e]));
+        }
+    }
+
+    // Decoding
+    *crcOk = decDecode16(&w->dec, w->llr.data(), cfg->L, rnti, w->infoDec.data());
+    int nBitErrors = 0;
+    for (int i = 0; i < nInfo; ++i)
+        nBitErrors += __builtin_popcountll(w->info[i] ^ w->infoDec[i]);
+    return nBitErrors;
+}
+
+void simRun(const simCfg_s *cfg, std::vector<simPoint_s> *points) {
+    std::shared_ptr<const plan_s> plan = planGet(planCacheDefault(), &cfg->params);
+    const params_s *p = &plan->params;
+    int n = poolThreads(cfg->nThreads);
+
+    // Per worker decoder and buffers, reused over all points
+    std::vector<simWorker_s> workers(n);
+    for (simWorker_s &w : workers) {
+        decCreate(&w.dec, plan);
+        w.info.resize(bvWords(p->A));
+        w.infoDec.resize(bvWords(p->A));
+        w.rm.resize(bvWords(p->E));
+        w.noise.resize(p->E);
+        w.sym.resize((p->E + 1) / 2);
+        w.llr.resize(p->E);
+    }
+
+    // Noise of unit energy symbols: sigma^2 = N0 / 2 = 1 / (2 m R Eb/N0) with m bits
+    // per symbol and R = A / E
+    double rate = double(p->A) / p->E;
+    int m = cfg->mod == SIM_QPSK ? 2 : 1;
+    int nTasks = int((cfg->maxBlocks + SIM_BATCH - 1) / SIM_BATCH);
+
+    points->clear();
+    for (int pt = 0; pt < (int)cfg->ebN0Db.size(); ++pt) {
+        double ebN0 = std::pow(10.0, cfg->ebN0Db[pt] / 10);
+        float sigma = float(std::sqrt(1.0 / (2 * m * rate * ebN0)));
+        simCount_s cnt{};
+
+        auto t0 = std::chrono::steady_clock::now();
+        poolRun(n, nTasks, [&](int task, int worker) {
+            if (cnt.nBlockErrors.load(std::memory_order_relaxed) >= cfg->targetErrors)
+                return;
+            int64_t b0 = int64_t(task) * SIM_BATCH;
+            int64_t b1 = std::min<int64_t>(b0 + SIM_BATCH, cfg->maxBlocks);
+            int64_t nBlockErrors = 0, nUndetected = 0, nBitErrors = 0;
+            for (int64_t b = b0; b < b1; ++b) {
+                bool crcOk;
+                int e = simBlock(cfg, plan.get(), pt, b, sigma, &workers[worker], &crcOk);
+                nBlockErrors += e > 0;
+                nUndetected += e > 0 && crcOk;
+                nBitErrors += e;
+            }
+            cnt.nBlocks.fetch_add(b1 - b0, std::memory_order_relaxed);
+            cnt.nBlockErrors.fetch_add(nBlockErrors, std::memory_order_relaxed);
+            cnt.nUndetected.fetch_add(nUndetected, std::memory_order_relaxed);
+            cnt.nBitErrors.fetch_add(nBitErrors, std::memory_order_relaxed);
+        });
+        auto t1 = std::chrono::steady_clock::now();
+
+        points->push_back({cfg->ebN0Db[pt], cnt.nBlocks.load(), cnt.nBlockErrors.load(),
+                           cnt.nUndetected.load(), cnt.nBitErrors.load(),
+                           std::chrono::duration<double>(t1 - t0).count()});
+    }
+}
+
+void simCsv(std::ostream &os, const simCfg_s *cfg, const std::vector<simPoint_s> &points,
+            bool header) {
+    const params_s *p = &cfg->params;
+    if (header)
+        os << "A,K,E,N,L,mod,ebn0_db,blocks,block_errors,undetected,bit_errors,bler,ber,"
+              "seconds"
+           << std::endl;
+    for (const simPoint_s &pt : points) {
+        double bler = pt.nBlocks ? double(pt.nBlockErrors) / pt.nBlocks : 0.0;
+        double nBits = double(pt.nBlocks) * p->A;
+        double ber = pt.nBlocks ? pt.nBitErrors / nBits : 0.0;
+        os << p->A << "," << p->K << "," << p->E << "," << p->N << "," << cfg->L << ","
+           << (cfg->mod == SIM_QPSK ? "qpsk" : "bpsk") << "," << pt.ebN0Db << ","
+           << pt.nBlocks << "," << pt.nBlockErrors << "," << pt.nUndetected << ","
+           << pt.nBitErrors << "," << bler << "," << ber << "," << pt.seconds
+           << std::endl;
+    }
+}
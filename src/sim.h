@@ -0,0 +1,47 @@
+#ifndef SIM_H_
+#define SIM_H_
+
+#include "encdl.h"
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// Monte-Carlo link level simulation: random info bits and RNTI, planEncode, BPSK or
+// QPSK, AWGN, CA-SCL decoding, block error when the decoded info bits differ.
+// Blocks draw their bits and noise from streams keyed by (seed, point, block), so a
+// block's outcome does not depend on the thread that runs it.
+
+typedef enum simMod_e { SIM_BPSK, SIM_QPSK } simMod_e;
+
+typedef struct simCfg_s {
+    params_s params;
+    std::vector<double> ebN0Db; // Sweep points
+    int L;                      // Decoder list size
+    int mod;                    // simMod_e
+    int64_t maxBlocks;          // Per point
+    int64_t targetErrors;       // Stop a point after this many block errors
+    int nThreads;               // 0 = all cores
+    uint64_t seed;
+} simCfg_s;
+
+typedef struct simPoint_s {
+    double ebN0Db;
+    int64_t nBlocks;
+    int64_t nBlockErrors;
+    int64_t nUndetected; // Block errors with the CRC passing
+    int64_t nBitErrors;  // Info bits
+    double seconds;
+} simPoint_s;
+
+// Defaults of all but params: 0 to 6 dB in 0.5 dB steps, L = 8, BPSK, 10^5 blocks,
+// 100 errors
+void simDefaults(simCfg_s *cfg);
+
+// Run the sweep, workers check the error target between batches of blocks
+void simRun(const simCfg_s *cfg, std::vector<simPoint_s> *points);
+
+// CSV rows of a sweep, the header when header is set
+void simCsv(std::ostream &os, const simCfg_s *cfg, const std::vector<simPoint_s> &points,
+            bool header = true);
+
+#endif // SIM_H_
@@ -0,0 +1,729 @@
+#include "simd.h"
+#include "polar.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_X86
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define SIMD_ARM
+#endif
+
+// Masks of the lower half of each 2s-bit block
+static const uint64_t masks[6] = {0x5555555555555555ull, 0x3333333333333333ull,
+                                  0x0f0f0f0f0f0f0f0full, 0x00ff00ff00ff00ffull,
+                                  0x0000ffff0000ffffull, 0x00000000ffffffffull};
+
+/* Scalar */
+
+static void polarBitsScalar(uint64_t *u, int n, int N) {
+    for (int w = 0; w < n; ++w)
+        u[w] = polarEncWord(u[w], N);
+}
+
+static void polarWordsScalar(uint64_t *u, int n) {
+    for (int s = 1; s < n; s <<= 1)
+        for (int i = 0; i < n; i += 2 * s)
+            for (int j = i; j < i + s; ++j)
+                u[j] ^= u[j + s];
+}
+
+static void gatherBitsScalar(const uint64_t *src, const uint16_t *idx, int n,
+                             uint64_t *dst) {
+    for (int w = 0; w < (n + 63) >> 6; ++w)
+        dst[w] = 0;
+    for (int i = 0; i < n; ++i)
+        dst[i >> 6] |= ((src[idx[i] >> 6] >> (idx[i] & 63)) & 1) << (i & 63);
+}
+
+template <class T>
+static void decFScalar(const T *a, int h, const uint8_t *lane, T *c) {
+    const int W = SIMD_DEC_LANES;
+    for (int i = 0; i < h; ++i)
+        for (int p = 0; p < W; ++p) {
+            T x = a[i * W + lane[p]], y = a[(i + h) * W + lane[p]];
+            int m = std::min(std::abs(x), std::abs(y));
+            c[i * W + p] = T((x ^ y) < 0 ? -m : m);
+        }
+}
+
+template <class T>
+static void decGScalar(const T *a, const uint8_t *bits, int h, const uint8_t *lane,
+                       T *c) {
+    const int W = SIMD_DEC_LANES, vMax = std::numeric_limits<T>::max();
+    for (int i = 0; i < h; ++i)
+        for (int p = 0; p < W; ++p) {
+            T x = a[i * W + lane[p]], y = a[(i + h) * W + lane[p]];
+            int v = (bits[i] >> p) & 1 ? y - x : y + x;
+            c[i * W + p] = T(std::min(std::max(v, -vMax), vMax));
+        }
+}
+
+static void decSortScalar(uint32_t *key, const uint8_t *lo, const uint8_t *hi, int n) {
+    const int W = SIMD_DEC_LANES;
+    for (int c = 0; c < n; ++c)
+        for (int p = 0; p < W; ++p) {
+            uint32_t x = key[lo[c] * W + p], y = key[hi[c] * W + p];
+            key[lo[c] * W + p] = std::min(x, y);
+            key[hi[c] * W + p] = std::max(x, y);
+        }
+}
+
+/* Gaussian noise. Philox4x32-10 (Salmon et al., SC11), then Box-Muller on 24-bit
+   uniforms with polynomial log and sincos. The vector kernels repeat the scalar
+   operations one for one without FMA, so every instruction set gives the same bits;
+   the build compiles this file with -ffp-contract=off to keep the scalar ones unfused.
+   The radius is at most sqrt(2 ln 2^24) = 5.77 sigma. */
+
+#define PHILOX_M0 0xd2511f53u
+#define PHILOX_M1 0xcd9e8d57u
+#define PHILOX_W0 0x9e3779b9u
+#define PHILOX_W1 0xbb67ae85u
+
+// x = 4 counter words in, 4 random words out
+static inline void philoxScalar(uint32_t *x, uint32_t k0, uint32_t k1) {
+    for (int r = 0; r < 10; ++r) {
+        uint64_t p0 = uint64_t(PHILOX_M0) * x[0], p1 = uint64_t(PHILOX_M1) * x[2];
+        uint32_t x0 = uint32_t(p1 >> 32) ^ x[1] ^ k0;
+        uint32_t x2 = uint32_t(p0 >> 32) ^ x[3] ^ k1;
+        x[0] = x0;
+        x[1] = uint32_t(p1);
+        x[2] = x2;
+        x[3] = uint32_t(p0);
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+}
+
+// ln u, u in (0, 1]: u = m 2^e with m in [sqrt(1/2), sqrt(2)), ln m = 2 atanh(s)
+static const float GAUSS_LN2 = 0.693147182f;
+static const float GAUSS_L[5] = {2.0f, 2.0f / 3, 2.0f / 5, 2.0f / 7, 2.0f / 9};
+// sin and cos of |t| <= pi / 4
+static const float GAUSS_S[5] = {1.0f, -1.0f / 6, 1.0f / 120, -1.0f / 5040,
+                                 1.0f / 362880};
+static const float GAUSS_C[5] = {1.0f, -1.0f / 2, 1.0f / 24, -1.0f / 720, 1.0f / 40320};
+static const float GAUSS_PI_2 = 1.57079637f;
+
+static inline float gaussBits(uint32_t b) {
+    float f;
+    std::memcpy(&f, &b, 4);
+    return f;
+}
+
+static inline float gaussLog(float u) {
+    uint32_t b;
+    std::memcpy(&b, &u, 4);
+    b -= 0x3f3504f3u; // sqrt(1/2)
+    int e = int32_t(b) >> 23;
+    float m = gaussBits((b & 0x7fffffu) + 0x3f3504f3u);
+    float t = (m - 1.0f) / (m + 1.0f), t2 = t * t;
+    float p = GAUSS_L[4];
+    for (int i = 3; i >= 0; --i)
+        p = p * t2 + GAUSS_L[i];
+    return float(e) * GAUSS_LN2 + t * p;
+}
+
+// Box-Muller pair of uniforms u1 in (0, 1] and u2 in [0, 1): angle 2 pi u2 in
+// quadrant q and remainder t
+static inline void gaussPair(uint32_t x1, uint32_t x2, float sigma, float *out) {
+    float u1 = float((x1 >> 8) + 1) * (1.0f / 16777216);
+    float u2 = float(x2 >> 8) * (4.0f / 16777216);
+    float r = std::sqrt(-2.0f * gaussLog(u1)) * sigma;
+    int q = int(u2 + 0.5f);
+    float t = (u2 - float(q)) * GAUSS_PI_2, t2 = t * t;
+    float ps = GAUSS_S[4], pc = GAUSS_C[4];
+    for (int i = 3; i >= 0; --i) {
+        ps = ps * t2 + GAUSS_S[i];
+        pc = pc * t2 + GAUSS_C[i];
+    }
+    float sn = t * ps, cs = pc;
+    if (q & 1)
+        std::swap(sn, cs);
+    uint32_t negC = uint32_t((q + 1) & 2) << 30, negS = uint32_t(q & 2) << 30;
+    uint32_t bc, bs;
+    std::memcpy(&bc, &cs, 4);
+    std::memcpy(&bs, &sn, 4);
+    out[0] = r * gaussBits(bc ^ negC);
+    out[1] = r * gaussBits(bs ^ negS);
+}
+
+static void gaussScalar(const uint32_t *key, uint64_t stream, uint64_t ctr, int nBlocks,
+                        float sigma, float *out) {
+    for (int b = 0; b < nBlocks; ++b, ++ctr, out += 4) {
+        uint32_t x[4] = {uint32_t(ctr), uint32_t(ctr >> 32), uint32_t(stream),
+                         uint32_t(stream >> 32)};
+        philoxScalar(x, key[0], key[1]);
+        gaussPair(x[0], x[1], sigma, out);
+        gaussPair(x[2], x[3], sigma, out + 2);
+    }
+}
+
+static inline bool textSep(char c) {
+    return c == '\n' || c == ' ' || c == ',' || c == '\r' || c == '\t';
+}
+
+// m bits at bit k of dst, words are cleared when first written
+static inline void textAppend(uint64_t *dst, int64_t *k, uint64_t bits, int m) {
+    int o = *k & 63;
+    uint64_t *w = &dst[*k >> 6];
+    w[0] = o ? w[0] | bits << o : bits;
+    if (o + m > 64)
+        w[1] = bits >> (64 - o);
+    *k += m;
+}
+
+// Bytes from i on, prevDigit when the byte before i is a digit
+static int64_t textBitsTail(const char *p, size_t i, size_t n, uint64_t *dst, int64_t k,
+                            bool prevDigit) {
+    for (; i < n; ++i) {
+        char c = p[i];
+        if (c == '0' || c == '1') {
+            if (prevDigit)
+                return -1;
+            textAppend(dst, &k, uint64_t(c - '0'), 1);
+            prevDigit = true;
+        } else if (textSep(c)) {
+            prevDigit = false;
+        } else {
+            return -1;
+        }
+    }
+    return k;
+}
+
+static int64_t textBitsScalar(const char *p, size_t n, uint64_t *dst) {
+    return textBitsTail(p, 0, n, dst, 0, false);
+}
+
+static const simdKernels_s kernelsScalar = {
+    SIMD_SCALAR, "scalar", polarBitsScalar, polarWordsScalar, gatherBitsScalar,
+    gaussScalar, textBitsScalar, decFScalar<int16_t>, decGScalar<int16_t>,
+    decFScalar<int8_t>, decGScalar<int8_t>, decSortScalar};
+
+#if defined(SIMD_X86)
+
+/* AVX2, 4 words per register */
+
+__attribute__((target("avx2"))) static void polarBitsAvx2(uint64_t *u, int n, int N) {
+    int w = 0;
+    for (; w + 4 <= n; w += 4) {
+        __m256i x = _mm256_loadu_si256((__m256i *)&u[w]);
+#define POLAR_BITS_STAGE(k, s)                                                           \
+    if (N > s)                                                                           \
+        x = _mm256_xor_si256(                                                            \
+            x, _mm256_and_si256(_mm256_srli_epi64(x, s), _mm256_set1_epi64x(masks[k])));
+        POLAR_BITS_STAGE(0, 1)
+        POLAR_BITS_STAGE(1, 2)
+        POLAR_BITS_STAGE(2, 4)
+        POLAR_BITS_STAGE(3, 8)
+        POLAR_BITS_STAGE(4, 16)
+        POLAR_BITS_STAGE(5, 32)
+#undef POLAR_BITS_STAGE
+        _mm256_storeu_si256((__m256i *)&u[w], x);
+    }
+    polarBitsScalar(u + w, n - w, N);
+}
+
+__attribute__((target("avx2"))) static void polarWordsAvx2(uint64_t *u, int n) {
+    if (n < 4) {
+        polarWordsScalar(u, n);
+        return;
+    }
+
+    // Strides of 1 and 2 words inside a register
+    const __m256i m1 = _mm256_set_epi64x(0, -1, 0, -1);
+    for (int w = 0; w < n; w += 4) {
+        __m256i x = _mm256_loadu_si256((__m256i *)&u[w]);
+        __m256i y = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(3, 3, 1, 1));
+        x = _mm256_xor_si256(x, _mm256_and_si256(y, m1));
+        y = _mm256_permute2x128_si256(x, x, 0x81);
+        x = _mm256_xor_si256(x, y);
+        _mm256_storeu_si256((__m256i *)&u[w], x);
+    }
+
+    // Strides of 4 words and more with wide XORs
+    for (int s = 4; s < n; s <<= 1) {
+        for (int i = 0; i < n; i += 2 * s) {
+            for (int j = i; j < i + s; j += 4) {
+                __m256i a = _mm256_loadu_si256((__m256i *)&u[j]);
+                __m256i b = _mm256_loadu_si256((__m256i *)&u[j + s]);
+                _mm256_storeu_si256((__m256i *)&u[j], _mm256_xor_si256(a, b));
+            }
+        }
+    }
+}
+
+__attribute__((target("avx2"))) static void
+gatherBitsAvx2(const uint64_t *src, const uint16_t *idx, int n, uint64_t *dst) {
+    for (int w = 0; w < (n + 63) >> 6; ++w)
+        dst[w] = 0;
+    const __m128i m63 = _mm_set1_epi32(63);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        // Gather 4 source words, move the wanted bit to the sign and collect the signs
+        __m128i id = _mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i *)&idx[i]));
+        __m256i x =
+            _mm256_i32gather_epi64((const long long *)src, _mm_srli_epi32(id, 6), 8);
+        __m256i sh = _mm256_cvtepu32_epi64(_mm_sub_epi32(m63, _mm_and_si128(id, m63)));
+        x = _mm256_sllv_epi64(x, sh);
+        uint64_t bits = _mm256_movemask_pd(_mm256_castsi256_pd(x));
+        dst[i >> 6] |= bits << (i & 63);
+    }
+    for (; i < n; ++i)
+        dst[i >> 6] |= ((src[idx[i] >> 6] >> (idx[i] & 63)) & 1) << (i & 63);
+}
+
+// Byte shuffle moving lane lane[p] of each element to lane p, in both 128-bit halves
+__attribute__((target("avx2"))) static inline __m256i decLanes(const uint8_t *lane,
+                                                              int width) {
+    alignas(16) uint8_t ctl[16];
+    for (int b = 0; b < 16; ++b) {
+        int e = b / (width * SIMD_DEC_LANES), p = b / width % SIMD_DEC_LANES;
+        ctl[b] = uint8_t((e * SIMD_DEC_LANES + lane[p]) * width + b % width);
+    }
+    return _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *)ctl));
+}
+
+// Magnitudes are compared unsigned so that -max - 1 behaves as in the scalar kernel
+__attribute__((target("avx2"))) static inline __m256i decF16Vec(__m256i x, __m256i y) {
+    __m256i m = _mm256_min_epu16(_mm256_abs_epi16(x), _mm256_abs_epi16(y));
+    __m256i s = _mm256_or_si256(_mm256_xor_si256(x, y), _mm256_set1_epi16(1));
+    return _mm256_sign_epi16(m, s);
+}
+
+// Sign +-1 of lane l from bit l of the lane bits, then y -+ x
+__attribute__((target("avx2"))) static inline __m256i decG16Vec(__m256i x, __m256i y,
+                                                               int bits) {
+    const __m256i bit = _mm256_setr_epi16(1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024,
+                                          2048, 4096, 8192, 16384, -32768);
+    __m256i s = _mm256_and_si256(_mm256_set1_epi16(int16_t(bits)), bit);
+    s = _mm256_or_si256(_mm256_cmpeq_epi16(s, bit), _mm256_set1_epi16(1));
+    x = _mm256_adds_epi16(y, _mm256_sign_epi16(x, s));
+    return _mm256_max_epi16(x, _mm256_set1_epi16(-32767));
+}
+
+// Two elements per register, a node of size 2 in a half register
+__attribute__((target("avx2"))) static void decF16Avx2(const int16_t *a, int h,
+                                                       const uint8_t *lane, int16_t *c) {
+    const int W = SIMD_DEC_LANES;
+    const __m256i ctl = decLanes(lane, 2);
+    if (h == 1) {
+        __m256i x = _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)a));
+        __m256i y = _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)&a[W]));
+        __m256i z = decF16Vec(_mm256_shuffle_epi8(x, ctl), _mm256_shuffle_epi8(y, ctl));
+        _mm_storeu_si128((__m128i *)c, _mm256_castsi256_si128(z));
+        return;
+    }
+    for (int i = 0; i < h; i += 2) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)&a[i * W]);
+        __m256i y = _mm256_loadu_si256((const __m256i *)&a[(i + h) * W]);
+        __m256i z = decF16Vec(_mm256_shuffle_epi8(x, ctl), _mm256_shuffle_epi8(y, ctl));
+        _mm256_storeu_si256((__m256i *)&c[i * W], z);
+    }
+}
+
+__attribute__((target("avx2"))) static void decG16Avx2(const int16_t *a,
+                                                       const uint8_t *bits, int h,
+                                                       const uint8_t *lane, int16_t *c) {
+    const int W = SIMD_DEC_LANES;
+    const __m256i ctl = decLanes(lane, 2);
+    if (h == 1) {
+        __m256i x = _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)a));
+        __m256i y = _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)&a[W]));
+        __m256i z =
+            decG16Vec(_mm256_shuffle_epi8(x, ctl), _mm256_shuffle_epi8(y, ctl), bits[0]);
+        _mm_storeu_si128((__m128i *)c, _mm256_castsi256_si128(z));
+        return;
+    }
+    for (int i = 0; i < h; i += 2) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)&a[i * W]);
+        __m256i y = _mm256_loadu_si256((const __m256i *)&a[(i + h) * W]);
+        __m256i z = decG16Vec(_mm256_shuffle_epi8(x, ctl), _mm256_shuffle_epi8(y, ctl),
+                              bits[i] | bits[i + 1] << 8);
+        _mm256_storeu_si256((__m256i *)&c[i * W], z);
+    }
+}
+
+__attribute__((target("avx2"))) static inline __m256i decF8Vec(__m256i x, __m256i y) {
+    __m256i m = _mm256_min_epu8(_mm256_abs_epi8(x), _mm256_abs_epi8(y));
+    __m256i s = _mm256_or_si256(_mm256_xor_si256(x, y), _mm256_set1_epi8(1));
+    return _mm256_sign_epi8(m, s);
+}
+
+// Byte e of the 32 lane bits spread over the lanes of element e, one bit each
+__attribute__((target("avx2"))) static inline __m256i decG8Vec(__m256i x, __m256i y,
+                                                              uint32_t bits) {
+    const __m256i spread = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1,
+                                            1, 2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3,
+                                            3, 3);
+    const __m256i bit = _mm256_set1_epi64x(int64_t(0x8040201008040201ull));
+    __m256i s = _mm256_shuffle_epi8(_mm256_set1_epi32(int(bits)), spread);
+    s = _mm256_or_si256(_mm256_cmpeq_epi8(_mm256_and_si256(s, bit), bit),
+                        _mm256_set1_epi8(1));
+    x = _mm256_adds_epi8(y, _mm256_sign_epi8(x, s));
+    return _mm256_max_epi8(x, _mm256_set1_epi8(-127));
+}
+
+// Four elements per register, nodes of size 2 and 4 in part of one
+__attribute__((target("avx2"))) static void decF8Avx2(const int8_t *a, int h,
+                                                      const uint8_t *lane, int8_t *c) {
+    const int W = SIMD_DEC_LANES;
+    const __m256i ctl = decLanes(lane, 1);
+    if (h < 4) {
+        alignas(32) int8_t x[32] = {}, y[32] = {}, z[32];
+        std::memcpy(x, a, h * W);
+        std::memcpy(y, &a[h * W], h * W);
+        __m256i u = _mm256_shuffle_epi8(_mm256_load_si256((__m256i *)x), ctl);
+        __m256i v = _mm256_shuffle_epi8(_mm256_load_si256((__m256i *)y), ctl);
+        v = decF8Vec(u, v);
+        _mm256_store_si256((__m256i *)z, v);
+        std::memcpy(c, z, h * W);
+        return;
+    }
+    for (int i = 0; i < h; i += 4) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)&a[i * W]);
+        __m256i y = _mm256_loadu_si256((const __m256i *)&a[(i + h) * W]);
+        __m256i z = decF8Vec(_mm256_shuffle_epi8(x, ctl), _mm256_shuffle_epi8(y, ctl));
+        _mm256_storeu_si256((__m256i *)&c[i * W], z);
+    }
+}
+
+__attribute__((target("avx2"))) static void decG8Avx2(const int8_t *a,
+                                                      const uint8_t *bits, int h,
+                                                      const uint8_t *lane, int8_t *c) {
+    const int W = SIMD_DEC_LANES;
+    const __m256i ctl = decLanes(lane, 1);
+    if (h < 4) {
+        alignas(32) int8_t x[32] = {}, y[32] = {}, z[32];
+        std::memcpy(x, a, h * W);
+        std::memcpy(y, &a[h * W], h * W);
+        uint32_t b = 0;
+        for (int i = 0; i < h; ++i)
+            b |= uint32_t(bits[i]) << (8 * i);
+        __m256i u = _mm256_shuffle_epi8(_mm256_load_si256((__m256i *)x), ctl);
+        __m256i v = _mm256_shuffle_epi8(_mm256_load_si256((__m256i *)y), ctl);
+        v = decG8Vec(u, v, b);
+        _mm256_store_si256((__m256i *)z, v);
+        std::memcpy(c, z, h * W);
+        return;
+    }
+    for (int i = 0; i < h; i += 4) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)&a[i * W]);
+        __m256i y = _mm256_loadu_si256((const __m256i *)&a[(i + h) * W]);
+        uint32_t b = bits[i] | bits[i + 1] << 8 | bits[i + 2] << 16 |
+                     uint32_t(bits[i + 3]) << 24;
+        __m256i z = decG8Vec(_mm256_shuffle_epi8(x, ctl), _mm256_shuffle_epi8(y, ctl), b);
+        _mm256_storeu_si256((__m256i *)&c[i * W], z);
+    }
+}
+
+__attribute__((target("avx2"))) static void decSortAvx2(uint32_t *key, const uint8_t *lo,
+                                                        const uint8_t *hi, int n) {
+    const int W = SIMD_DEC_LANES;
+    for (int c = 0; c < n; ++c) {
+        __m256i *x = (__m256i *)&key[lo[c] * W], *y = (__m256i *)&key[hi[c] * W];
+        __m256i u = _mm256_loadu_si256(x), v = _mm256_loadu_si256(y);
+        _mm256_storeu_si256(x, _mm256_min_epu32(u, v));
+        _mm256_storeu_si256(y, _mm256_max_epu32(u, v));
+    }
+}
+
+// hi:lo = a * m per 32-bit lane
+__attribute__((target("avx2"))) static inline void philoxMul(__m256i a, __m256i m,
+                                                             __m256i *hi, __m256i *lo) {
+    __m256i pe = _mm256_mul_epu32(a, m);
+    __m256i po = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), m);
+    *lo = _mm256_blend_epi32(pe, _mm256_slli_epi64(po, 32), 0xaa);
+    *hi = _mm256_blend_epi32(_mm256_srli_epi64(pe, 32), po, 0xaa);
+}
+
+__attribute__((target("avx2"))) static inline __m256 gaussLogAvx2(__m256 u) {
+    const __m256i sqrtHalf = _mm256_set1_epi32(0x3f3504f3);
+    __m256i b = _mm256_sub_epi32(_mm256_castps_si256(u), sqrtHalf);
+    __m256 e = _mm256_cvtepi32_ps(_mm256_srai_epi32(b, 23));
+    __m256 m = _mm256_castsi256_ps(
+        _mm256_add_epi32(_mm256_and_si256(b, _mm256_set1_epi32(0x7fffff)), sqrtHalf));
+    const __m256 one = _mm256_set1_ps(1.0f);
+    __m256 t = _mm256_div_ps(_mm256_sub_ps(m, one), _mm256_add_ps(m, one));
+    __m256 t2 = _mm256_mul_ps(t, t);
+    __m256 p = _mm256_set1_ps(GAUSS_L[4]);
+    for (int i = 3; i >= 0; --i)
+        p = _mm256_add_ps(_mm256_mul_ps(p, t2), _mm256_set1_ps(GAUSS_L[i]));
+    return _mm256_add_ps(_mm256_mul_ps(e, _mm256_set1_ps(GAUSS_LN2)),
+                         _mm256_mul_ps(t, p));
+}
+
+__attribute__((target("avx2"))) static inline void
+gaussPairAvx2(__m256i x1, __m256i x2, __m256 sigma, __m256 *re, __m256 *im) {
+    __m256i n1 = _mm256_add_epi32(_mm256_srli_epi32(x1, 8), _mm256_set1_epi32(1));
+    __m256 u1 = _mm256_mul_ps(_mm256_cvtepi32_ps(n1), _mm256_set1_ps(1.0f / 16777216));
+    __m256 u2 = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(x2, 8)),
+                              _mm256_set1_ps(4.0f / 16777216));
+    __m256 r = _mm256_mul_ps(
+        _mm256_sqrt_ps(_mm256_mul_ps(_mm256_set1_ps(-2.0f), gaussLogAvx2(u1))), sigma);
+    __m256i q = _mm256_cvttps_epi32(_mm256_add_ps(u2, _mm256_set1_ps(0.5f)));
+    __m256 t = _mm256_mul_ps(_mm256_sub_ps(u2, _mm256_cvtepi32_ps(q)),
+                             _mm256_set1_ps(GAUSS_PI_2));
+    __m256 t2 = _mm256_mul_ps(t, t);
+    __m256 ps = _mm256_set1_ps(GAUSS_S[4]), pc = _mm256_set1_ps(GAUSS_C[4]);
+    for (int i = 3; i >= 0; --i) {
+        ps = _mm256_add_ps(_mm256_mul_ps(ps, t2), _mm256_set1_ps(GAUSS_S[i]));
+        pc = _mm256_add_ps(_mm256_mul_ps(pc, t2), _mm256_set1_ps(GAUSS_C[i]));
+    }
+    __m256 sn = _mm256_mul_ps(t, ps);
+    __m256 odd = _mm256_castsi256_ps(_mm256_slli_epi32(q, 31));
+    __m256 cs = _mm256_blendv_ps(pc, sn, odd);
+    sn = _mm256_blendv_ps(sn, pc, odd);
+    const __m256i two = _mm256_set1_epi32(2);
+    __m256i negC = _mm256_slli_epi32(
+        _mm256_and_si256(_mm256_add_epi32(q, _mm256_set1_epi32(1)), two), 30);
+    __m256i negS = _mm256_slli_epi32(_mm256_and_si256(q, two), 30);
+    *re = _mm256_mul_ps(r, _mm256_xor_ps(cs, _mm256_castsi256_ps(negC)));
+    *im = _mm256_mul_ps(r, _mm256_xor_ps(sn, _mm256_castsi256_ps(negS)));
+}
+
+// 8 blocks per iteration, block j in lane j
+__attribute__((target("avx2"))) static void gaussAvx2(const uint32_t *key,
+                                                      uint64_t stream, uint64_t ctr,
+                                                      int nBlocks, float sigma,
+                                                      float *out) {
+    const __m256i m0 = _mm256_set1_epi32(int(PHILOX_M0));
+    const __m256i m1 = _mm256_set1_epi32(int(PHILOX_M1));
+    const __m256 sig = _mm256_set1_ps(sigma);
+    int b = 0;
+    for (; b + 8 <= nBlocks; b += 8, ctr += 8, out += 32) {
+        // Philox rounds. Blocks where the low counter word wraps go scalar.
+        if (uint32_t(ctr) > 0xfffffff8u) {
+            gaussScalar(key, stream, ctr, 8, sigma, out);
+            continue;
+        }
+        __m256i x0 = _mm256_add_epi32(_mm256_set1_epi32(int(uint32_t(ctr))),
+                                      _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+        __m256i x1 = _mm256_set1_epi32(int(uint32_t(ctr >> 32)));
+        __m256i x2 = _mm256_set1_epi32(int(uint32_t(stream)));
+        __m256i x3 = _mm256_set1_epi32(int(uint32_t(stream >> 32)));
+        uint32_t k0 = key[0], k1 = key[1];
+        for (int r = 0; r < 10; ++r) {
+            __m256i hi0, lo0, hi1, lo1;
+            philoxMul(x0, m0, &hi0, &lo0);
+            philoxMul(x2, m1, &hi1, &lo1);
+            x0 = _mm256_xor_si256(_mm256_xor_si256(hi1, x1), _mm256_set1_epi32(int(k0)));
+            x2 = _mm256_xor_si256(_mm256_xor_si256(hi0, x3), _mm256_set1_epi32(int(k1)));
+            x1 = lo1;
+            x3 = lo0;
+            k0 += PHILOX_W0;
+            k1 += PHILOX_W1;
+        }
+
+        // Box-Muller of (x0, x1) and (x2, x3)
+        __m256 reA, imA, reB, imB;
+        gaussPairAvx2(x0, x1, sig, &reA, &imA);
+        gaussPairAvx2(x2, x3, sig, &reB, &imB);
+
+        // Interleave to reA imA reB imB of block 0, then block 1, ...
+        __m256d a0 = _mm256_castps_pd(_mm256_unpacklo_ps(reA, imA)); // Blocks 0 1 4 5
+        __m256d a1 = _mm256_castps_pd(_mm256_unpackhi_ps(reA, imA)); // Blocks 2 3 6 7
+        __m256d b0 = _mm256_castps_pd(_mm256_unpacklo_ps(reB, imB));
+        __m256d b1 = _mm256_castps_pd(_mm256_unpackhi_ps(reB, imB));
+        __m256d v0 = _mm256_unpacklo_pd(a0, b0); // Blocks 0 4
+        __m256d v1 = _mm256_unpackhi_pd(a0, b0); // Blocks 1 5
+        __m256d v2 = _mm256_unpacklo_pd(a1, b1); // Blocks 2 6
+        __m256d v3 = _mm256_unpackhi_pd(a1, b1); // Blocks 3 7
+        _mm256_storeu_pd((double *)out, _mm256_permute2f128_pd(v0, v1, 0x20));
+        _mm256_storeu_pd((double *)(out + 8), _mm256_permute2f128_pd(v2, v3, 0x20));
+        _mm256_storeu_pd((double *)(out + 16), _mm256_permute2f128_pd(v0, v1, 0x31));
+        _mm256_storeu_pd((double *)(out + 24), _mm256_permute2f128_pd(v2, v3, 0x31));
+    }
+    gaussScalar(key, stream, ctr, nBlocks - b, sigma, out);
+}
+
+// Even bits of x in the low 16 bits
+static inline uint32_t textEven(uint32_t x) {
+    x &= 0x55555555u;
+    x = (x | x >> 1) & 0x33333333u;
+    x = (x | x >> 2) & 0x0f0f0f0fu;
+    x = (x | x >> 4) & 0x00ff00ffu;
+    return (x | x >> 8) & 0x0000ffffu;
+}
+
+// Digit and separator masks of 32 bytes at once. One token per line with LF endings
+// gives alternating digit masks, compacted with shifts; anything else takes one bit
+// per digit.
+__attribute__((target("avx2"))) static int64_t textBitsAvx2(const char *p, size_t n,
+                                                            uint64_t *dst) {
+    const __m256i c0 = _mm256_set1_epi8('0'), c1 = _mm256_set1_epi8('1');
+    const __m256i nl = _mm256_set1_epi8('\n'), sp = _mm256_set1_epi8(' ');
+    const __m256i cm = _mm256_set1_epi8(','), cr = _mm256_set1_epi8('\r');
+    const __m256i tb = _mm256_set1_epi8('\t');
+    int64_t k = 0;
+    uint32_t prev = 0;
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(p + i));
+        uint32_t d1 = _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, c1));
+        uint32_t d = d1 | uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, c0)));
+        __m256i s = _mm256_or_si256(_mm256_cmpeq_epi8(v, nl), _mm256_cmpeq_epi8(v, sp));
+        s = _mm256_or_si256(s, _mm256_or_si256(_mm256_cmpeq_epi8(v, cm),
+                                               _mm256_cmpeq_epi8(v, cr)));
+        s = _mm256_or_si256(s, _mm256_cmpeq_epi8(v, tb));
+        uint32_t sep = _mm256_movemask_epi8(s);
+        if ((d | sep) != ~0u || (d & ((d << 1) | prev)))
+            return -1;
+        prev = d >> 31;
+        if (d == 0x55555555u) {
+            textAppend(dst, &k, textEven(d1), 16);
+        } else if (d == 0xaaaaaaaau) {
+            textAppend(dst, &k, textEven(d1 >> 1), 16);
+        } else {
+            uint64_t bits = 0;
+            int m = 0;
+            for (uint32_t t = d; t; t &= t - 1)
+                bits |= uint64_t((d1 >> __builtin_ctz(t)) & 1) << m++;
+            if (m)
+                textAppend(dst, &k, bits, m);
+        }
+    }
+    return textBitsTail(p, i, n, dst, k, prev);
+}
+
+static const simdKernels_s kernelsAvx2 = {
+    SIMD_AVX2, "avx2", polarBitsAvx2, polarWordsAvx2, gatherBitsAvx2, gaussAvx2,
+    textBitsAvx2, decF16Avx2, decG16Avx2, decF8Avx2, decG8Avx2, decSortAvx2};
+
+/* AVX-512, 8 words per register */
+
+__attribute__((target("avx512f"))) static void polarWordsAvx512(uint64_t *u, int n) {
+    if (n < 8) {
+        polarWordsAvx2(u, n);
+        return;
+    }
+
+    // Strides of 1, 2 and 4 words inside a register, lanes l with (l & s) == 0 take
+    // lane l + s
+    const __m512i idx1 = _mm512_set_epi64(7, 7, 5, 5, 3, 3, 1, 1);
+    const __m512i idx2 = _mm512_set_epi64(7, 6, 7, 6, 3, 2, 3, 2);
+    const __m512i idx4 = _mm512_set_epi64(7, 6, 5, 4, 7, 6, 5, 4);
+    for (int w = 0; w < n; w += 8) {
+        __m512i x = _mm512_loadu_si512(&u[w]);
+        x = _mm512_mask_xor_epi64(x, 0x55, x, _mm512_permutexvar_epi64(idx1, x));
+        x = _mm512_mask_xor_epi64(x, 0x33, x, _mm512_permutexvar_epi64(idx2, x));
+        x = _mm512_mask_xor_epi64(x, 0x0f, x, _mm512_permutexvar_epi64(idx4, x));
+        _mm512_storeu_si512(&u[w], x);
+    }
+
+    // Strides of 8 words and more with wide XORs
+    for (int s = 8; s < n; s <<= 1) {
+        for (int i = 0; i < n; i += 2 * s) {
+            for (int j = i; j < i + s; j += 8) {
+                __m512i a = _mm512_loadu_si512(&u[j]);
+                __m512i b = _mm512_loadu_si512(&u[j + s]);
+                _mm512_storeu_si512(&u[j], _mm512_xor_si512(a, b));
+            }
+        }
+    }
+}
+
+__attribute__((target("avx512f"))) static void
+gatherBitsAvx512(const uint64_t *src, const uint16_t *idx, int n, uint64_t *dst) {
+    for (int w = 0; w < (n + 63) >> 6; ++w)
+        dst[w] = 0;
+    const __m256i m63 = _mm256_set1_epi32(63);
+    const __m512i one = _mm512_set1_epi64(1);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        // Gather 8 source words, shift the wanted bit to bit 0 and test it
+        __m256i id = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)&idx[i]));
+        __m512i x = _mm512_i32gather_epi64(_mm256_srli_epi32(id, 6), src, 8);
+        x = _mm512_srlv_epi64(x, _mm512_cvtepu32_epi64(_mm256_and_si256(id, m63)));
+        uint64_t bits = _mm512_test_epi64_mask(x, one);
+        dst[i >> 6] |= bits << (i & 63);
+    }
+    for (; i < n; ++i)
+        dst[i >> 6] |= ((src[idx[i] >> 6] >> (idx[i] & 63)) & 1) << (i & 63);
+}
+
+static const simdKernels_s kernelsAvx512 = {
+    SIMD_AVX512, "avx512", polarBitsAvx2, polarWordsAvx512, gatherBitsAvx512, gaussAvx2,
+    textBitsAvx2, decF16Avx2, decG16Avx2, decF8Avx2, decG8Avx2, decSortAvx2};
+
+#elif defined(SIMD_ARM)
+
+/* NEON, 2 words per register */
+
+static void polarBitsNeon(uint64_t *u, int n, int N) {
+    int w = 0;
+    for (; w + 2 <= n; w += 2) {
+        uint64x2_t x = vld1q_u64(&u[w]);
+#define POLAR_BITS_STAGE(k, s)                                                           \
+    if (N > s)                                                                           \
+        x = veorq_u64(x, vandq_u64(vshrq_n_u64(x, s), vdupq_n_u64(masks[k])));
+        POLAR_BITS_STAGE(0, 1)
+        POLAR_BITS_STAGE(1, 2)
+        POLAR_BITS_STAGE(2, 4)
+        POLAR_BITS_STAGE(3, 8)
+        POLAR_BITS_STAGE(4, 16)
+        POLAR_BITS_STAGE(5, 32)
+#undef POLAR_BITS_STAGE
+        vst1q_u64(&u[w], x);
+    }
+    polarBitsScalar(u + w, n - w, N);
+}
+
+static void polarWordsNeon(uint64_t *u, int n) {
+    // Stride of 1 word inside a register
+    for (int w = 0; w + 1 < n; w += 2)
+        u[w] ^= u[w + 1];
+
+    // Strides of 2 words and more with wide XORs
+    for (int s = 2; s < n; s <<= 1) {
+        for (int i = 0; i < n; i += 2 * s) {
+            for (int j = i; j < i + s; j += 2)
+                vst1q_u64(&u[j], veorq_u64(vld1q_u64(&u[j]), vld1q_u64(&u[j + s])));
+        }
+    }
+}
+
+static const simdKernels_s kernelsNeon = {
+    SIMD_NEON, "neon", polarBitsNeon, polarWordsNeon, gatherBitsScalar, gaussScalar,
+    textBitsScalar, decFScalar<int16_t>, decGScalar<int16_t>, decFScalar<int8_t>,
+    decGScalar<int8_t>, decSortScalar};
+
+#endif
+
+const simdKernels_s *simdFind(simdIsa_e isa) {
+    switch (isa) {
+    case SIMD_SCALAR:
+        return &kernelsScalar;
+#if defined(SIMD_X86)
+    case SIMD_AVX2:
+        return __builtin_cpu_supports("avx2") ? &kernelsAvx2 : nullptr;
+    case SIMD_AVX512:
+        return __builtin_cpu_supports("avx512f") ? &kernelsAvx512 : nullptr;
+#elif defined(SIMD_ARM)
+    case SIMD_NEON:
+        return &kernelsNeon;
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+static const simdKernels_s *simdResolve() {
+    const simdIsa_e order[] = {SIMD_AVX512, SIMD_AVX2, SIMD_NEON};
+    for (simdIsa_e isa : order)
+        if (const simdKernels_s *k = simdFind(isa))
+            return k;
+    return &kernelsScalar;
+}
+
+const simdKernels_s *simdGet() {
+    static const simdKernels_s *kernels = simdResolve();
+    return kernels;
+}
@@ -0,0 +1,50 @@
+#ifndef SIMD_H_
+#define SIMD_H_
+
+#include <cstddef>
+#include <cstdint>
+
+typedef enum simdIsa_e { SIMD_SCALAR, SIMD_NEON, SIMD_AVX2, SIMD_AVX512 } simdIsa_e;
+
+// Paths of the list decoder kernels, one 128-bit register of int16 LLRs
+#define SIMD_DEC_LANES 8
+
+// Kernels for one instruction set
+typedef struct simdKernels_s {
+    simdIsa_e isa;
+    const char *name;
+    // Polar butterfly stages with bit strides 1, 2, ..., min(32, N/2) in n words
+    void (*polarBits)(uint64_t *u, int n, int N);
+    // Polar butterfly stages with word strides 1, 2, ..., n/2, n a power of two
+    void (*polarWords)(uint64_t *u, int n);
+    // dst bit i = src bit idx[i] for i < n, fills bvWords(n) words of dst
+    void (*gatherBits)(const uint64_t *src, const uint16_t *idx, int n, uint64_t *dst);
+    // 4 N(0, sigma^2) floats per Philox4x32-10 block ctr, ctr + 1, ... of stream and
+    // key, nBlocks * 4 into out. Bit exact across instruction sets.
+    void (*gauss)(const uint32_t *key, uint64_t stream, uint64_t ctr, int nBlocks,
+                  float sigma, float *out);
+    // Text of lone '0' / '1' tokens separated by whitespace or commas packed into dst,
+    // LSB first, bvWords(n / 2 + 1) words. The token count, -1 for any other token.
+    int64_t (*textBits)(const char *p, size_t n, uint64_t *dst);
+    // Min-sum f and g of a list decoder node of size 2h over its SIMD_DEC_LANES paths,
+    // LLR i of path p at a[i * SIMD_DEC_LANES + p]. Path p reads lane lane[p] of a and
+    // writes lane p of c: c_i = f(a_i, a_i+h) and c_i = a_i+h -+ a_i by bit p of
+    // bits[i], saturated to [-max, max]. LLRs in [-max, max].
+    void (*decF16)(const int16_t *a, int h, const uint8_t *lane, int16_t *c);
+    void (*decG16)(const int16_t *a, const uint8_t *bits, int h, const uint8_t *lane,
+                   int16_t *c);
+    void (*decF8)(const int8_t *a, int h, const uint8_t *lane, int8_t *c);
+    void (*decG8)(const int8_t *a, const uint8_t *bits, int h, const uint8_t *lane,
+                  int8_t *c);
+    // Compare-exchange network over rows of SIMD_DEC_LANES keys: for c < n, rows lo[c]
+    // and hi[c] of key become their lane-wise minimum and maximum
+    void (*decSort)(uint32_t *key, const uint8_t *lo, const uint8_t *hi, int n);
+} simdKernels_s;
+
+// Best kernels for the running CPU, selected once
+const simdKernels_s *simdGet();
+
+// Kernels for a given instruction set, nullptr if not supported by the CPU or build
+const simdKernels_s *simdFind(simdIsa_e isa);
+
+#endif // SIMD_H_
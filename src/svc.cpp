@@ -0,0 +1,374 @@
+#include "svc.h"
+#include "bitvec.h"
+#include "plan.h"
+#include "pool.h"
+#include "ring.h"
+#include "util.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include <xtensor/xarray.hpp>
+
+namespace fs = std::filesystem;
+
+// Polls of an empty ring before a worker starts sleeping between polls
+#define SVC_SPIN 1024
+#define SVC_SLEEP_US 20
+
+int64_t svcNow() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void svcDefaults(svcCfg_s *cfg) {
+    cfg->nThreads = 4;
+    cfg->nSlots = 1024;
+    cfg->aMax = PLAN_K_MAX;
+    cfg->eMax = 8192;
+    cfg->shmName = nullptr;
+    cfg->udpPort = 0;
+}
+
+static void svcIdle(int *nIdle) {
+    if (++*nIdle < SVC_SPIN)
+        std::this_thread::yield();
+    else
+        std::this_thread::sleep_for(std::chrono::microseconds(SVC_SLEEP_US));
+}
+
+// Whether the request fits the slots, the plan checks the rest
+static bool svcValid(const svc_s *svc, const svcReq_s *req) {
+    const params_s *p = &req->params;
+    return p->A > 0 && p->A <= svc->cfg.aMax && p->E > 0 && p->E <= svc->cfg.eMax &&
+           (p->link == LINK_DL || p->link == LINK_UL) &&
+           req->nBytes >= SVC_HDR + 8 * bvWords(p->A);
+}
+
+static void svcWorker(svc_s *svc, int w) {
+    svcStats_s *st = &svc->stats[w];
+    std::shared_ptr<const plan_s> plan;
+    uint64_t key = 0;
+    int nIdle = 0;
+    while (!svc->stop.load(std::memory_order_relaxed)) {
+        uint64_t reqPos, rspPos;
+        auto *req = static_cast<svcReq_s *>(ringAcquire(&svc->req, &reqPos));
+        if (!req) {
+            svcIdle(&nIdle);
+            continue;
+        }
+        nIdle = 0;
+        int64_t t0 = svcNow();
+
+        // Response slot, holding the request meanwhile so the request ring fills
+        // up and producers see the backpressure
+        svcRsp_s *rsp;
+        bool stalled = false;
+        while (!(rsp = static_cast<svcRsp_s *>(ringClaim(&svc->rsp, &rspPos)))) {
+            if (svc->stop.load(std::memory_order_relaxed))
+                return;
+            stalled = true;
+            std::this_thread::yield();
+        }
+        st->nStalls += stalled;
+
+        // Plan, the cache lock is only taken when the configuration changes
+        int status = svcValid(svc, req) ? SVC_OK : SVC_INVALID;
+        if (status == SVC_OK && (!plan || planKey(&req->params) != key)) {
+            try {
+                plan = planGet(planCacheDefault(), &req->params);
+                key = planKey(&req->params);
+            } catch (const std::exception &) {
+                plan.reset();
+                status = SVC_INVALID;
+            }
+        }
+        if (status == SVC_OK && req->deadlineNs && t0 > req->deadlineNs)
+            status = SVC_EXPIRED;
+
+        // Encoding from the request slot into the response slot
+        rsp->id = req->id;
+        rsp->slot = req->slot;
+        rsp->worker = w;
+        rsp->E = 0;
+        if (status == SVC_OK) {
+            planEncode(plan.get(), svcInfo(req), req->rnti, svcRm(rsp));
+            rsp->E = req->params.E;
+        }
+        int64_t deadline = req->deadlineNs;
+        ringRelease(&svc->req, reqPos);
+
+        // Deadline accounting at publication
+        int64_t t1 = svcNow();
+        if (status == SVC_OK && deadline && t1 > deadline)
+            status = SVC_LATE;
+        rsp->status = status;
+        rsp->latencyNs = t1 - t0;
+        rsp->slackNs = deadline ? deadline - t1 : 0;
+        ringPublish(&svc->rsp, rspPos);
+
+        st->nReq += 1;
+        st->nOk += status == SVC_OK;
+        st->nLate += status == SVC_LATE;
+        st->nExpired += status == SVC_EXPIRED;
+        st->nInvalid += status == SVC_INVALID;
+        if (status == SVC_OK || status == SVC_LATE) {
+            st->latencyNs += t1 - t0;
+            st->maxLatencyNs = std::max(st->maxLatencyNs, t1 - t0);
+        }
+        if (deadline)
+            st->minSlackNs = std::min(st->minSlackNs, deadline - t1);
+    }
+}
+
+// Datagrams are received straight into claimed request slots. A slot is only claimed
+// once a datagram is waiting, so an idle socket does not hold up the ring, and while
+// the ring is full the socket is not read and the kernel buffer takes the backlog.
+static void svcUdp(svc_s *svc) {
+    svcStats_s *st = &svc->stats.back();
+    pollfd pfd = {svc->udpFd, POLLIN, 0};
+    while (!svc->stop.load(std::memory_order_relaxed)) {
+        if (poll(&pfd, 1, 100) <= 0)
+            continue;
+        uint64_t pos;
+        void *slot;
+        bool stalled = false;
+        while (!(slot = ringClaim(&svc->req, &pos))) {
+            if (svc->stop.load(std::memory_order_relaxed))
+                return;
+            stalled = true;
+            std::this_thread::yield();
+        }
+        st->nStalls += stalled;
+
+        // Short and truncated datagrams become invalid requests with nBytes 0
+        auto *req = static_cast<svcReq_s *>(slot);
+        ssize_t slotBytes = svc->req.hdr->slotBytes;
+        ssize_t n = recv(svc->udpFd, slot, slotBytes, MSG_DONTWAIT | MSG_TRUNC);
+        if (n < ssize_t(sizeof(svcReq_s)))
+            std::memset(req, 0, sizeof(svcReq_s));
+        req->nBytes = n >= ssize_t(sizeof(svcReq_s)) && n <= slotBytes ? n : 0;
+        ringPublish(&svc->req, pos);
+    }
+}
+
+void svcStart(svc_s *svc, const svcCfg_s *cfg) {
+    svc->cfg = *cfg;
+    svc->stop.store(false);
+    svc->udpFd = -1;
+    int n = poolThreads(cfg->nThreads);
+
+    // Rings, request slots sized for aMax info bits and response slots for eMax
+    // rate matched bits. A single worker is the only consumer of the request ring, the
+    // client the only consumer of the response ring.
+    std::string name = cfg->shmName ? cfg->shmName : "";
+    int reqBytes = SVC_HDR + 8 * bvWords(cfg->aMax);
+    int rspBytes = SVC_HDR + 8 * bvWords(cfg->eMax);
+    ringCreate(&svc->req, cfg->shmName ? (name + ".req").c_str() : nullptr, cfg->nSlots,
+               reqBytes, n == 1 ? RING_SC : 0);
+    ringCreate(&svc->rsp, cfg->shmName ? (name + ".rsp").c_str() : nullptr, cfg->nSlots,
+               rspBytes, RING_SC);
+
+    // Socket
+    if (cfg->udpPort) {
+        svc->udpFd = socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons(cfg->udpPort);
+        int rcvBuf = 4 << 20;
+        if (svc->udpFd >= 0)
+            setsockopt(svc->udpFd, SOL_SOCKET, SO_RCVBUF, &rcvBuf, sizeof(rcvBuf));
+        if (svc->udpFd < 0 || bind(svc->udpFd, (sockaddr *)&addr, sizeof(addr)) != 0) {
+            if (svc->udpFd >= 0)
+                close(svc->udpFd);
+            ringClose(&svc->req);
+            ringClose(&svc->rsp);
+            throw std::runtime_error("cannot bind UDP port " +
+                                     std::to_string(cfg->udpPort));
+        }
+    }
+
+    // Threads
+    svcStats_s zero = {};
+    zero.minSlackNs = std::numeric_limits<int64_t>::max();
+    svc->stats.assign(n + 1, zero);
+    for (int w = 0; w < n; ++w)
+        svc->threads.emplace_back(svcWorker, svc, w);
+    if (svc->udpFd >= 0)
+        svc->threads.emplace_back(svcUdp, svc);
+}
+
+void svcStop(svc_s *svc, svcStats_s *stats) {
+    svc->stop.store(true);
+    for (std::thread &t : svc->threads)
+        t.join();
+    svc->threads.clear();
+    if (svc->udpFd >= 0)
+        close(svc->udpFd);
+    svc->udpFd = -1;
+    ringClose(&svc->req);
+    ringClose(&svc->rsp);
+
+    // The socket reader only counts stalls
+    *stats = {};
+    stats->minSlackNs = std::numeric_limits<int64_t>::max();
+    for (const svcStats_s &s : svc->stats) {
+        stats->nReq += s.nReq;
+        stats->nOk += s.nOk;
+        stats->nLate += s.nLate;
+        stats->nExpired += s.nExpired;
+        stats->nInvalid += s.nInvalid;
+        stats->nStalls += s.nStalls;
+        stats->latencyNs += s.latencyNs;
+        stats->maxLatencyNs = std::max(stats->maxLatencyNs, s.maxLatencyNs);
+        stats->minSlackNs = std::min(stats->minSlackNs, s.minSlackNs);
+    }
+}
+
+void svcPrint(const svcStats_s *stats) {
+    int64_t nEnc = stats->nOk + stats->nLate;
+    std::cout << "nReq: " << stats->nReq << ", nOk: " << stats->nOk
+              << ", nLate: " << stats->nLate << ", nExpired: " << stats->nExpired
+              << ", nInvalid: " << stats->nInvalid << ", nStalls: " << stats->nStalls
+              << std::endl;
+    std::cout << "latency mean: " << (nEnc ? double(stats->latencyNs) / nEnc : 0.0)
+              << " ns, max: " << stats->maxLatencyNs << " ns";
+    if (stats->minSlackNs != std::numeric_limits<int64_t>::max())
+        std::cout << ", min slack: " << stats->minSlackNs << " ns";
+    std::cout << std::endl;
+}
+
+static std::atomic<bool> svcInterrupted{false};
+
+static void svcOnSignal(int) { svcInterrupted.store(true); }
+
+// A test vector of the load generator
+typedef struct svcTv_s {
+    params_s params;
+    uint16_t rnti;
+    bitvec_s info;
+    bitvec_s rm; // Reference
+} svcTv_s;
+
+static void svcLoadTv(const fs::path &dir, svcTv_s *tv) {
+    readParams(dir, &tv->params);
+    readPacked(dir / "info_bits.txt", tv->params.A, &tv->info);
+    tv->rnti = readRnti(dir / "rnti_bits.txt");
+    readPacked(dir / "rm_bits.txt", tv->params.E, &tv->rm);
+}
+
+void svcServe(const svcCfg_s *cfg, const std::vector<fs::path> &dirs, double seconds,
+              int slotUs) {
+    std::vector<svcTv_s> tvs(dirs.size());
+    for (size_t i = 0; i < dirs.size(); ++i) {
+        svcLoadTv(dirs[i], &tvs[i]);
+        planGet(planCacheDefault(), &tvs[i].params); // Not built within the first slot
+    }
+
+    svc_s svc;
+    svcStart(&svc, cfg);
+    std::signal(SIGINT, svcOnSignal);
+    std::cout << "serving " << svc.stats.size() - 1 << " workers, " << svc.req.hdr->nSlots
+              << " ring slots";
+    if (cfg->shmName)
+        std::cout << ", rings " << cfg->shmName << ".req / .rsp";
+    if (cfg->udpPort)
+        std::cout << ", UDP port " << cfg->udpPort;
+    std::cout << std::endl;
+
+    int64_t start = svcNow();
+    int64_t end = seconds > 0 ? start + int64_t(seconds * 1e9) : 0;
+    auto running = [&] { return !svcInterrupted.load() && (!end || svcNow() < end); };
+
+    if (tvs.empty()) {
+        while (running())
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    } else {
+        // Load generator, one request per test vector per slot
+        std::atomic<int64_t> nSent{0};
+        std::atomic<bool> done{false};
+        int64_t nSubmitStalls = 0;
+        std::thread producer([&] {
+            int64_t slotNs = int64_t(slotUs) * 1000;
+            for (uint32_t s = 0; running(); ++s) {
+                int64_t t = start + s * slotNs;
+                while (svcNow() < t)
+                    std::this_thread::yield();
+                for (size_t i = 0; i < tvs.size(); ++i) {
+                    uint64_t pos;
+                    void *slot;
+                    bool stalled = false;
+                    while (!(slot = ringClaim(&svc.req, &pos))) {
+                        stalled = true;
+                        std::this_thread::yield();
+                    }
+                    nSubmitStalls += stalled;
+                    auto *req = static_cast<svcReq_s *>(slot);
+                    req->id = uint64_t(s) * tvs.size() + i;
+                    req->deadlineNs = t + slotNs;
+                    req->slot = s;
+                    req->rnti = tvs[i].rnti;
+                    req->params = tvs[i].params;
+                    int nWords = bvWords(tvs[i].params.A);
+                    req->nBytes = SVC_HDR + 8 * nWords;
+                    std::copy_n(tvs[i].info.words.data(), nWords, svcInfo(req));
+                    ringPublish(&svc.req, pos);
+                    nSent.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            done.store(true);
+        });
+
+        // Client, responses checked in place against the references
+        int64_t nRecv = 0, nDiffBits = 0;
+        std::vector<uint8_t> slotMissed;
+        while (!done.load() || nRecv < nSent.load()) {
+            uint64_t pos;
+            auto *rsp = static_cast<svcRsp_s *>(ringAcquire(&svc.rsp, &pos));
+            if (!rsp) {
+                std::this_thread::yield();
+                continue;
+            }
+            const svcTv_s &tv = tvs[rsp->id % tvs.size()];
+            if (rsp->status == SVC_OK || rsp->status == SVC_LATE)
+                for (int e = 0; e < tv.params.E; ++e)
+                    nDiffBits +=
+                        int((svcRm(rsp)[e >> 6] >> (e & 63)) & 1) != bvGet(&tv.rm, e);
+            if (rsp->slot >= slotMissed.size())
+                slotMissed.resize(rsp->slot + 1, 0);
+            slotMissed[rsp->slot] |= rsp->status != SVC_OK;
+            ringRelease(&svc.rsp, pos);
+            ++nRecv;
+        }
+        producer.join();
+        int64_t nMissed = std::count(slotMissed.begin(), slotMissed.end(), 1);
+        std::cout << "nSlots: " << slotMissed.size() << ", nSlotsMissed: " << nMissed
+                  << ", nDiffBits: " << nDiffBits << ", nSubmitStalls: " << nSubmitStalls
+                  << std::endl;
+    }
+
+    double wallS = (svcNow() - start) * 1e-9;
+    svcStats_s stats;
+    svcStop(&svc, &stats);
+    std::signal(SIGINT, SIG_DFL);
+    svcPrint(&stats);
+    std::cout << "wall: " << wallS * 1e3 << " ms, " << stats.nReq / wallS << " requests/s"
+              << std::endl;
+}
@@ -0,0 +1,114 @@
+#ifndef SVC_H_
+#define SVC_H_
+
+#include "encdl.h"
+#include "ring.h"
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Encoding service: requests of info bits + RNTI + params arrive in a request ring
+// (and optionally as UDP datagrams of the same layout), workers encode them with the
+// plan cache straight from the request slot into a response slot of the response ring.
+// Requests and responses are host byte order, the payload words start at SVC_HDR.
+
+#define SVC_HDR 64
+
+// Response status
+typedef enum svcStatus_e {
+    SVC_OK,
+    SVC_LATE,    // Encoded, but published after the deadline
+    SVC_EXPIRED, // Deadline passed before encoding, no rate matched bits
+    SVC_INVALID, // Unsupported params or payload larger than the slot
+} svcStatus_e;
+
+// Request header, bvWords(A) info words follow at SVC_HDR
+typedef struct svcReq_s {
+    uint64_t id;        // Echoed in the response
+    int64_t deadlineNs; // svcNow clock, 0 for none
+    uint32_t slot;      // Scheduling slot of the codeword, echoed
+    uint16_t rnti;
+    uint16_t nBytes; // Header + payload, checked against the params
+    params_s params;
+} svcReq_s;
+
+// Response header, bvWords(E) rate matched words follow at SVC_HDR
+typedef struct svcRsp_s {
+    uint64_t id;
+    uint32_t slot;
+    int32_t status;    // svcStatus_e
+    int32_t E;         // 0 unless encoded
+    int32_t worker;
+    int64_t latencyNs; // Request acquired to response published
+    int64_t slackNs;   // Deadline minus publication time, negative when late
+} svcRsp_s;
+
+static_assert(sizeof(svcReq_s) <= SVC_HDR && sizeof(svcRsp_s) <= SVC_HDR, "svc headers");
+
+inline uint64_t *svcInfo(svcReq_s *req) {
+    return reinterpret_cast<uint64_t *>(reinterpret_cast<uint8_t *>(req) + SVC_HDR);
+}
+inline uint64_t *svcRm(svcRsp_s *rsp) {
+    return reinterpret_cast<uint64_t *>(reinterpret_cast<uint8_t *>(rsp) + SVC_HDR);
+}
+
+// Monotonic clock of the deadlines in ns, CLOCK_MONOTONIC so other processes on the
+// host share it
+int64_t svcNow();
+
+typedef struct svcCfg_s {
+    int nThreads;        // Encoding workers, 0 = all cores
+    int nSlots;          // Depth of both rings
+    int aMax;            // Largest A a request slot holds
+    int eMax;            // Largest E a response slot holds
+    const char *shmName; // Rings <name>.req and <name>.rsp in shared memory, or nullptr
+    int udpPort;         // Requests on this UDP port too, 0 for none
+} svcCfg_s;
+
+// Per worker accounting, summed by svcStop. One line each so the workers' counters do
+// not share cache lines.
+typedef struct alignas(RING_LINE) svcStats_s {
+    int64_t nReq;
+    int64_t nOk;
+    int64_t nLate;
+    int64_t nExpired;
+    int64_t nInvalid;
+    int64_t nStalls;   // Waits for a ring slot: the consumer or the workers lagging
+    int64_t latencyNs; // Sum over encoded requests
+    int64_t maxLatencyNs;
+    int64_t minSlackNs;
+} svcStats_s;
+
+typedef struct svc_s {
+    svcCfg_s cfg;
+    ring_s req; // MPMC: clients and the socket produce, workers consume
+    ring_s rsp; // Workers produce, clients consume
+    std::atomic<bool> stop;
+    int udpFd;
+    std::vector<svcStats_s> stats; // Workers, then the socket reader
+    std::vector<std::thread> threads;
+} svc_s;
+
+// 4 workers of 1024-slot rings for DCI sized payloads, E up to 8192, no socket
+void svcDefaults(svcCfg_s *cfg);
+
+// Create the rings and start the workers (and the socket reader). Throws when the
+// rings or socket cannot be set up.
+void svcStart(svc_s *svc, const svcCfg_s *cfg);
+
+// Stop the threads, close the rings and sum the accounting into stats
+void svcStop(svc_s *svc, svcStats_s *stats);
+
+void svcPrint(const svcStats_s *stats);
+
+// The service for seconds (0 until SIGINT). With test vector dirs a load generator
+// submits all of them every slotUs with the end of the slot as deadline and a client
+// checks the rate matched bits of each response against the reference.
+void svcServe(const svcCfg_s *cfg, const std::vector<fs::path> &dirs, double seconds,
+              int slotUs);
+
+#endif // SVC_H_
@@ -0,0 +1,62 @@
+#include "trace.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+static const struct {
+    const char *name;
+    uint32_t stage;
+} traceStageNames[] = {
+    {"args", TRACE_ARGS},     {"params", TRACE_PARAMS}, {"info", TRACE_INFO_BITS},
+    {"crc", TRACE_CRC},       {"scr", TRACE_SCRAMBLE},  {"intrl", TRACE_INTRL},
+    {"frozen", TRACE_FROZEN}, {"enc", TRACE_ENC},       {"rm", TRACE_RM},
+    {"mtx", TRACE_MTX},       {"all", TRACE_ALL},
+};
+
+int traceParseLevel(const char *s) {
+    static const char *names[] = {"off", "error", "info", "debug"};
+    for (int i = 0; i < 4; ++i)
+        if (std::strcmp(s, names[i]) == 0)
+            return i;
+    return -1;
+}
+
+uint32_t traceParseStages(const char *s) {
+    uint32_t stages = 0;
+    std::string list(s);
+    size_t pos = 0;
+    while (pos <= list.size()) {
+        size_t end = list.find(',', pos);
+        if (end == std::string::npos)
+            end = list.size();
+        std::string name = list.substr(pos, end - pos);
+        for (const auto &it : traceStageNames)
+            if (name == it.name)
+                stages |= it.stage;
+        pos = end + 1;
+    }
+    return stages;
+}
+
+static trace_s traceInit() {
+    // Quiet unless asked, all stages once a level is given
+    trace_s t = {TRACE_ERROR, TRACE_ALL};
+    if (const char *s = std::getenv("XT_TRACE_LEVEL"))
+        if (int level = traceParseLevel(s); level >= 0)
+            t.level = level;
+    if (const char *s = std::getenv("XT_TRACE_STAGES"))
+        t.stages = traceParseStages(s);
+    return t;
+}
+
+trace_s *traceGet() {
+    static trace_s t = traceInit();
+    return &t;
+}
+
+void traceSet(int level, uint32_t stages) {
+    trace_s *t = traceGet();
+    t->level = level;
+    t->stages = stages;
+}
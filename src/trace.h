@@ -0,0 +1,72 @@
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <cstdint>
+#include <iostream>
+
+// Stage tracing. XT_EX_TRACE=0 compiles every trace statement away, by default it
+// follows NDEBUG. At runtime the level and stage mask are read once from the
+// XT_TRACE_LEVEL (off, error, info, debug) and XT_TRACE_STAGES (comma separated
+// stage names or "all") environment variables, the default is quiet. "all" leaves out
+// the generator matrix dumps, they are on only when "mtx" is listed.
+
+#ifndef XT_EX_TRACE
+#ifdef NDEBUG
+#define XT_EX_TRACE 0
+#else
+#define XT_EX_TRACE 1
+#endif
+#endif
+
+typedef enum traceLevel_e {
+    TRACE_OFF = 0,
+    TRACE_ERROR,
+    TRACE_INFO,
+    TRACE_DEBUG,
+} traceLevel_e;
+
+typedef enum traceStage_e {
+    TRACE_ARGS = 1 << 0,
+    TRACE_PARAMS = 1 << 1,
+    TRACE_INFO_BITS = 1 << 2,
+    TRACE_CRC = 1 << 3,
+    TRACE_SCRAMBLE = 1 << 4,
+    TRACE_INTRL = 1 << 5,
+    TRACE_FROZEN = 1 << 6,
+    TRACE_ENC = 1 << 7,
+    TRACE_RM = 1 << 8,
+    TRACE_ALL = (1 << 9) - 1,
+    TRACE_MTX = 1 << 9, // Generator matrices, large, not part of TRACE_ALL
+} traceStage_e;
+
+typedef struct trace_s {
+    int level;
+    uint32_t stages;
+} trace_s;
+
+// Process wide settings, initialized from the environment on first use
+trace_s *traceGet();
+void traceSet(int level, uint32_t stages);
+
+// Parse a level name or a stage list, -1 / 0 when not recognized
+int traceParseLevel(const char *s);
+uint32_t traceParseStages(const char *s);
+
+inline bool traceOn(int level, uint32_t stage) {
+    const trace_s *t = traceGet();
+    return level <= t->level && (stage & t->stages);
+}
+
+#if XT_EX_TRACE
+#define XT_TRACE(level, stage, expr)                                                     \
+    do {                                                                                 \
+        if (traceOn(level, stage))                                                       \
+            std::cout << expr << std::endl;                                              \
+    } while (0)
+#else
+#define XT_TRACE(level, stage, expr)                                                     \
+    do {                                                                                 \
+    } while (0)
+#endif
+
+#endif // TRACE_H_
@@ -0,0 +1,211 @@
+#include "tvbin.h"
+#include "tvload.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <xtensor/xarray.hpp>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+static size_t tvAlign(size_t n) { return (n + 63) & ~size_t{63}; }
+
+// Shape, dtype and payload bounds of an entry in a file of size bytes. Dimensions are
+// limited below 2^30 so the payload size cannot overflow.
+static bool tvEntryOk(const tvEntry_s *e, size_t size) {
+    if ((e->dtype != TV_BITS && e->dtype != TV_INT32) || e->ndim < 1 || e->ndim > 2)
+        return false;
+    for (uint32_t d = 0; d < e->ndim; ++d)
+        if (e->shape[d] >= (uint64_t{1} << 30))
+            return false;
+    uint64_t rows = e->ndim > 1 ? e->shape[0] : 1, cols = e->shape[e->ndim - 1];
+    uint64_t need = rows * (e->dtype == TV_BITS ? 8 * ((cols + 63) >> 6) : 4 * cols);
+    return e->offset % 8 == 0 && e->offset <= size && e->nbytes <= size - e->offset &&
+           e->nbytes >= need;
+}
+
+void tvOpen(tvFile_s *f, fs::path path) {
+#if !defined(_WIN32)
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("cannot open " + path.string());
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        throw std::runtime_error("cannot stat " + path.string());
+    }
+    f->size = st.st_size;
+    void *base = mmap(nullptr, f->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+        throw std::runtime_error("cannot map " + path.string());
+    f->base = static_cast<const uint8_t *>(base);
+#else
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        throw std::runtime_error("cannot open " + path.string());
+    f->buf.assign(std::istreambuf_iterator<char>(in), {});
+    f->size = f->buf.size();
+    f->base = f->buf.data();
+#endif
+    f->hdr = reinterpret_cast<const tvHeader_s *>(f->base);
+    f->entries = reinterpret_cast<const tvEntry_s *>(f->base + sizeof(tvHeader_s));
+    bool ok = f->size >= sizeof(tvHeader_s) &&
+              std::memcmp(f->hdr->magic, TV_MAGIC, sizeof(f->hdr->magic)) == 0 &&
+              f->hdr->version == TV_VERSION &&
+              sizeof(tvHeader_s) + f->hdr->nEntries * sizeof(tvEntry_s) <= f->size;
+    for (uint32_t i = 0; ok && i < f->hdr->nEntries; ++i)
+        ok = tvEntryOk(&f->entries[i], f->size);
+    if (!ok) {
+        tvClose(f);
+        throw std::runtime_error("malformed test vector container " + path.string());
+    }
+    f->mtime = fs::last_write_time(path);
+}
+
+void tvClose(tvFile_s *f) {
+#if !defined(_WIN32)
+    if (f->base)
+        munmap(const_cast<uint8_t *>(f->base), f->size);
+#endif
+    f->buf.clear();
+    f->base = nullptr;
+    f->size = 0;
+}
+
+const tvFile_s *tvShared(fs::path dir) {
+    static std::mutex mtx;
+    static std::map<fs::path, std::unique_ptr<tvFile_s>> files;
+    fs::path path = dir / TV_FILE_NAME;
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = files.find(path);
+    if (it != files.end())
+        return it->second.get();
+    if (!fs::exists(path))
+        return nullptr;
+    auto f = std::make_unique<tvFile_s>();
+    tvOpen(f.get(), path);
+    return (files[path] = std::move(f)).get();
+}
+
+const tvEntry_s *tvSharedEntry(fs::path path, const tvFile_s **f) {
+    *f = tvShared(path.parent_path());
+    if (!*f)
+        return nullptr;
+    std::error_code ec;
+    fs::file_time_type mtime = fs::last_write_time(path, ec);
+    if (!ec && mtime > (*f)->mtime)
+        throw std::runtime_error(path.string() + " is newer than its " TV_FILE_NAME
+                                 ", convert the directory again");
+    return tvFind(*f, path.stem().c_str());
+}
+
+const tvEntry_s *tvFind(const tvFile_s *f, const char *name) {
+    for (uint32_t i = 0; i < f->hdr->nEntries; ++i)
+        if (std::strncmp(f->entries[i].name, name, TV_NAME_LEN) == 0)
+            return &f->entries[i];
+    return nullptr;
+}
+
+xt::xarray<int> tvLoad(const tvFile_s *f, const tvEntry_s *e) {
+    size_t rows = e->ndim > 1 ? e->shape[0] : 1;
+    size_t cols = e->shape[e->ndim - 1];
+    std::vector<size_t> shape(e->shape, e->shape + e->ndim);
+    xt::xarray<int> out(shape);
+    if (e->dtype == TV_INT32) {
+        const int32_t *p = reinterpret_cast<const int32_t *>(f->base + e->offset);
+        std::copy(p, p + rows * cols, out.data());
+    } else {
+        const uint64_t *p = reinterpret_cast<const uint64_t *>(f->base + e->offset);
+        size_t rowWords = tvRowWords(e);
+        for (size_t r = 0; r < rows; ++r)
+            for (size_t c = 0; c < cols; ++c)
+                out.data()[r * cols + c] = (p[r * rowWords + (c >> 6)] >> (c & 63)) & 1;
+    }
+    return out;
+}
+
+static std::vector<int> tvReadText(fs::path path) {
+    tvlArray_s text;
+    tvlRead(path, &text);
+    std::vector<int> v(text.n);
+    for (int64_t i = 0; i < text.n; ++i)
+        v[i] = tvlAt(&text, i);
+    return v;
+}
+
+void tvConvert(fs::path dir) {
+    // All text files of the directory, params first for the matrix shapes
+    std::map<std::string, std::vector<int>> arrays;
+    for (const auto &it : fs::directory_iterator(dir))
+        if (it.path().extension() == ".txt")
+            arrays[it.path().stem().string()] = tvReadText(it.path());
+    const std::vector<int> &params = arrays["params"];
+    if (params.size() < 5)
+        throw std::runtime_error("missing params.txt in " + dir.string());
+    int P = params[1], N = params[4];
+
+    // Entry table
+    std::vector<tvEntry_s> entries;
+    size_t offset = tvAlign(sizeof(tvHeader_s) + arrays.size() * sizeof(tvEntry_s));
+    for (const auto &[name, v] : arrays) {
+        tvEntry_s e = {};
+        std::strncpy(e.name, name.c_str(), TV_NAME_LEN - 1);
+        bool isBits =
+            std::all_of(v.begin(), v.end(), [](int x) { return x == 0 || x == 1; });
+        e.dtype = isBits && name != "params" ? TV_BITS : TV_INT32;
+        e.ndim = 1;
+        e.shape[0] = v.size();
+        if (name == "crc_gen_m" || name == "enc_gen_m") {
+            e.ndim = 2;
+            e.shape[0] = name == "crc_gen_m" ? P : N;
+            e.shape[1] = v.size() / e.shape[0];
+        }
+        e.nbytes = e.dtype == TV_BITS ? (e.ndim > 1 ? e.shape[0] : 1) * tvRowWords(&e) * 8
+                                      : v.size() * 4;
+        e.offset = offset;
+        offset = tvAlign(offset + e.nbytes);
+        entries.push_back(e);
+    }
+
+    // Header, table and payloads
+    std::vector<uint8_t> out(offset, 0);
+    tvHeader_s hdr = {};
+    std::memcpy(hdr.magic, TV_MAGIC, sizeof(hdr.magic));
+    hdr.version = TV_VERSION;
+    hdr.nEntries = entries.size();
+    std::memcpy(out.data(), &hdr, sizeof(hdr));
+    std::memcpy(out.data() + sizeof(hdr), entries.data(),
+                entries.size() * sizeof(tvEntry_s));
+    size_t i = 0;
+    for (const auto &[name, v] : arrays) {
+        const tvEntry_s &e = entries[i++];
+        if (e.dtype == TV_INT32) {
+            std::vector<int32_t> p(v.begin(), v.end());
+            std::memcpy(out.data() + e.offset, p.data(), e.nbytes);
+        } else {
+            uint64_t *p = reinterpret_cast<uint64_t *>(out.data() + e.offset);
+            size_t cols = e.shape[e.ndim - 1];
+            size_t rowWords = tvRowWords(&e);
+            for (size_t k = 0; k < v.size(); ++k)
+                p[(k / cols) * rowWords + ((k % cols) >> 6)] |= uint64_t(v[k])
+                                                                << ((k % cols) & 63);
+        }
+    }
+    std::ofstream of(dir / TV_FILE_NAME, std::ios::binary);
+    of.write(reinterpret_cast<const char *>(out.data()), out.size());
+}
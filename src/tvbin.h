@@ -0,0 +1,91 @@
+#ifndef TVBIN_H_
+#define TVBIN_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+#include <xtensor/xadapt.hpp>
+#include <xtensor/xarray.hpp>
+
+namespace fs = std::filesystem;
+
+// Binary test vector container, one file per test vector directory:
+//   header | entry table | payloads, each 64-byte aligned
+// Bit arrays are stored packed (64 bits per word, LSB first, rows word aligned),
+// index arrays as int32. The file is memory-mapped and entries are adapted in place.
+
+#define TV_MAGIC "XTTVBIN"
+#define TV_VERSION 1
+#define TV_FILE_NAME "tv.xtb"
+#define TV_NAME_LEN 48
+
+typedef enum tvDtype_e { TV_BITS = 1, TV_INT32 = 2 } tvDtype_e;
+
+typedef struct tvHeader_s {
+    char magic[8];
+    uint32_t version;
+    uint32_t nEntries;
+} tvHeader_s;
+
+typedef struct tvEntry_s {
+    char name[TV_NAME_LEN]; // File stem, e.g. "enc_gen_m"
+    uint32_t dtype;
+    uint32_t ndim;
+    uint64_t shape[2];
+    uint64_t offset; // Payload offset from the start of the file
+    uint64_t nbytes;
+} tvEntry_s;
+
+typedef struct tvFile_s {
+    const uint8_t *base;
+    size_t size;
+    const tvHeader_s *hdr;
+    const tvEntry_s *entries;
+    fs::file_time_type mtime;
+    std::vector<uint8_t> buf; // Only used when memory mapping is not available
+} tvFile_s;
+
+// Map a container, throws on a missing or malformed file: every entry must have a
+// known dtype, 1 or 2 dimensions and a payload inside the file covering its shape
+void tvOpen(tvFile_s *f, fs::path path);
+void tvClose(tvFile_s *f);
+
+// Container of directory dir, mapped on first use and kept mapped for the rest of the
+// run so views into it stay valid; nullptr when the directory has none. Thread safe.
+const tvFile_s *tvShared(fs::path dir);
+
+// Entry of text file path in the shared container of its directory, nullptr without
+// one or when the container lacks it. Throws when the text file is newer than the
+// container, it was edited after the conversion.
+const tvEntry_s *tvSharedEntry(fs::path path, const tvFile_s **f);
+
+// Entry by name, nullptr if absent
+const tvEntry_s *tvFind(const tvFile_s *f, const char *name);
+
+// Words per stored row of a bit array
+inline size_t tvRowWords(const tvEntry_s *e) {
+    return (e->shape[e->ndim - 1] + 63) >> 6;
+}
+
+// Zero-copy views: int32 entries as their shape, bit entries as rows x words
+inline auto tvAdaptInt(const tvFile_s *f, const tvEntry_s *e) {
+    const int32_t *p = reinterpret_cast<const int32_t *>(f->base + e->offset);
+    std::array<size_t, 2> shape{e->ndim > 1 ? e->shape[0] : 1, e->shape[e->ndim - 1]};
+    return xt::adapt(p, shape[0] * shape[1], xt::no_ownership(), shape);
+}
+
+inline auto tvAdaptWords(const tvFile_s *f, const tvEntry_s *e) {
+    const uint64_t *p = reinterpret_cast<const uint64_t *>(f->base + e->offset);
+    std::array<size_t, 2> shape{e->ndim > 1 ? e->shape[0] : 1, tvRowWords(e)};
+    return xt::adapt(p, shape[0] * shape[1], xt::no_ownership(), shape);
+}
+
+// Entry unpacked to int in its stored shape
+xt::xarray<int> tvLoad(const tvFile_s *f, const tvEntry_s *e);
+
+// Convert the text files of a test vector directory into dir / TV_FILE_NAME
+void tvConvert(fs::path dir);
+
+#endif // TVBIN_H_
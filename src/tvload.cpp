@@ -0,0 +1,228 @@
+#include "tvload.h"
+#include "bitvec.h"
+#include "pool.h"
+#include "simd.h"
+#include "tvbin.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <xtensor/xarray.hpp>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+static bool tvlSep(char c) {
+    return c == '\n' || c == ' ' || c == ',' || c == '\r' || c == '\t';
+}
+
+static void tvlInts(const char *p, size_t n, tvlArray_s *a) {
+    a->ints.clear();
+    a->ints.reserve(n / 2 + 1);
+    for (size_t i = 0; i < n;) {
+        if (tvlSep(p[i])) {
+            ++i;
+            continue;
+        }
+        bool neg = p[i] == '-';
+        i += neg;
+        if (i == n || p[i] < '0' || p[i] > '9')
+            throw std::runtime_error("malformed number in test vector text");
+        int64_t v = 0;
+        for (; i < n && p[i] >= '0' && p[i] <= '9'; ++i)
+            v = v * 10 + (p[i] - '0');
+        if (i < n && !tvlSep(p[i]))
+            throw std::runtime_error("malformed number in test vector text");
+        a->ints.push_back(int32_t(neg ? -v : v));
+    }
+    a->n = a->ints.size();
+}
+
+void tvlParse(const char *p, size_t n, tvlArray_s *a) {
+    // Bit files, the bulk of the corpus, packed in one pass
+    a->words.resize(bvWords(n / 2 + 1));
+    int64_t nBits = simdGet()->textBits(p, n, a->words.data());
+    if (nBits >= 0) {
+        a->bits = true;
+        a->n = nBits;
+        a->words.resize(bvWords(nBits));
+        a->ints.clear();
+        return;
+    }
+
+    // Anything else as integers
+    a->bits = false;
+    a->words.clear();
+    tvlInts(p, n, a);
+}
+
+void tvlRead(fs::path path, tvlArray_s *a) {
+#if !defined(_WIN32)
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("cannot open " + path.string());
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        throw std::runtime_error("cannot stat " + path.string());
+    }
+    size_t size = st.st_size;
+    if (size == 0) {
+        close(fd);
+        tvlParse(nullptr, 0, a);
+        return;
+    }
+    void *base = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+        throw std::runtime_error("cannot map " + path.string());
+    madvise(base, size, MADV_SEQUENTIAL);
+    try {
+        tvlParse(static_cast<const char *>(base), size, a);
+    } catch (...) {
+        munmap(base, size);
+        throw;
+    }
+    munmap(base, size);
+#else
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        throw std::runtime_error("cannot open " + path.string());
+    std::vector<char> buf(std::istreambuf_iterator<char>(in), {});
+    tvlParse(buf.data(), buf.size(), a);
+#endif
+}
+
+xt::xarray<int> tvlUnpack(const tvlArray_s *a) {
+    xt::xarray<int> out(std::vector<size_t>{size_t(a->n)});
+    if (a->bits)
+        for (int64_t i = 0; i < a->n; ++i)
+            out.data()[i] = (a->words[i >> 6] >> (i & 63)) & 1;
+    else
+        std::copy(a->ints.begin(), a->ints.end(), out.data());
+    return out;
+}
+
+void tvlOpen(tvl_s *tvl, fs::path dir) {
+    tvl->dir = dir;
+    tvl->files.clear();
+    tvl->loadNs.store(0);
+    tvl->nBytes.store(0);
+}
+
+void tvlClose(tvl_s *tvl) {
+    tvl->files.clear();
+}
+
+// Container entry: 1-D bit arrays are already packed like tvlArray_s
+static void tvlFromBin(const tvFile_s *bin, const tvEntry_s *e, tvlArray_s *a) {
+    if (e->dtype == TV_BITS && e->ndim == 1) {
+        const uint64_t *p = reinterpret_cast<const uint64_t *>(bin->base + e->offset);
+        a->bits = true;
+        a->n = e->shape[0];
+        a->words.assign(p, p + tvRowWords(e));
+        return;
+    }
+    xt::xarray<int> v = tvLoad(bin, e);
+    a->bits = false;
+    a->n = v.size();
+    a->ints.assign(v.data(), v.data() + v.size());
+}
+
+std::shared_ptr<const tvlArray_s> tvlGet(tvl_s *tvl, const std::string &stem) {
+    {
+        std::lock_guard<std::mutex> lock(tvl->mtx);
+        auto it = tvl->files.find(stem);
+        if (it != tvl->files.end())
+            return it->second;
+    }
+
+    // Read outside the lock, a concurrent read of the same file loses
+    auto t0 = std::chrono::steady_clock::now();
+    auto a = std::make_shared<tvlArray_s>();
+    fs::path path = tvl->dir / (stem + ".txt");
+    const tvFile_s *bin;
+    const tvEntry_s *e = tvSharedEntry(path, &bin);
+    if (e) {
+        tvlFromBin(bin, e, a.get());
+        tvl->nBytes += e->nbytes;
+    } else {
+        tvlRead(path, a.get());
+        tvl->nBytes += fs::file_size(path);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    tvl->loadNs += std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+
+    std::lock_guard<std::mutex> lock(tvl->mtx);
+    return tvl->files.emplace(stem, a).first->second;
+}
+
+void tvlPreload(tvl_s *tvl, int nThreads) {
+    std::vector<std::string> stems;
+    for (const auto &it : fs::directory_iterator(tvl->dir))
+        if (it.path().extension() == ".txt")
+            stems.push_back(it.path().stem().string());
+    poolRun(nThreads, stems.size(), [&](int task, int) { tvlGet(tvl, stems[task]); });
+}
+
+void tvlLoadAll(const std::vector<fs::path> &dirs, int nThreads) {
+    std::vector<fs::path> paths;
+    for (const fs::path &dir : dirs)
+        for (const auto &it : fs::directory_iterator(dir))
+            if (it.path().extension() == ".txt")
+                paths.push_back(it.path());
+    std::sort(paths.begin(), paths.end());
+
+    // Largest files first so the pool does not end on one of them
+    std::vector<uintmax_t> sizes(paths.size());
+    std::vector<int> order(paths.size());
+    for (size_t i = 0; i < paths.size(); ++i) {
+        sizes[i] = fs::file_size(paths[i]);
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(),
+              [&](int a, int b) { return sizes[a] > sizes[b]; });
+
+    std::atomic<int64_t> nValues{0}, nBitFiles{0};
+    std::mutex errMtx;
+    int nErrors = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    poolRun(nThreads, paths.size(), [&](int task, int) {
+        tvlArray_s a;
+        try {
+            tvlRead(paths[order[task]], &a);
+        } catch (const std::exception &e) {
+            std::lock_guard<std::mutex> lock(errMtx);
+            std::cerr << paths[order[task]].string() << ": " << e.what() << std::endl;
+            ++nErrors;
+            return;
+        }
+        nValues += a.n;
+        nBitFiles += a.bits;
+    });
+    auto t1 = std::chrono::steady_clock::now();
+
+    uintmax_t nBytes = 0;
+    for (uintmax_t s : sizes)
+        nBytes += s;
+    double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    std::cout << "nFiles: " << paths.size() << " (" << nBitFiles.load()
+              << " bits), nErrors: " << nErrors << ", nValues: " << nValues.load()
+              << std::endl;
+    std::cout << "threads: " << poolThreads(nThreads) << ", load: " << ms << " ms, "
+              << nBytes / (ms * 1e3) << " MB/s" << std::endl;
+}
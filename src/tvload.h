@@ -0,0 +1,64 @@
+#ifndef TVLOAD_H_
+#define TVLOAD_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <xtensor/xarray.hpp>
+
+namespace fs = std::filesystem;
+
+// Text test vector files memory-mapped and parsed without iostreams or locales. Files
+// of lone 0 / 1 tokens are packed straight into words by the textBits kernel of
+// simd.h, other files are parsed as decimal integers.
+typedef struct tvlArray_s {
+    bool bits;                   // 0 / 1 tokens only, packed into words
+    int64_t n;                   // Values
+    std::vector<uint64_t> words; // bits: bvWords(n), LSB first like bitvec_s
+    std::vector<int32_t> ints;   // Otherwise
+} tvlArray_s;
+
+// Parse n bytes of text, tokens separated by whitespace or commas. Throws on a token
+// that is not a decimal integer.
+void tvlParse(const char *p, size_t n, tvlArray_s *a);
+
+// Map and parse a file, throws when it cannot be read
+void tvlRead(fs::path path, tvlArray_s *a);
+
+inline int tvlAt(const tvlArray_s *a, int64_t i) {
+    return a->bits ? int((a->words[i >> 6] >> (i & 63)) & 1) : a->ints[i];
+}
+
+// Flat int array of the values, for the xtensor paths
+xt::xarray<int> tvlUnpack(const tvlArray_s *a);
+
+// Files of one test vector directory, each read on first access and kept. Thread
+// safe, different files load concurrently. Entries of the directory's shared
+// container (tvSharedEntry) are used instead of the text files when it has one.
+typedef struct tvl_s {
+    fs::path dir;
+    std::mutex mtx;
+    std::map<std::string, std::shared_ptr<const tvlArray_s>> files; // By stem
+    std::atomic<int64_t> loadNs; // Map and parse time of all files read so far
+    std::atomic<int64_t> nBytes;
+} tvl_s;
+
+void tvlOpen(tvl_s *tvl, fs::path dir);
+void tvlClose(tvl_s *tvl);
+
+// File dir / (stem + ".txt"), read now unless already loaded
+std::shared_ptr<const tvlArray_s> tvlGet(tvl_s *tvl, const std::string &stem);
+
+// Read all text files of the directory up front, one pool task per file
+void tvlPreload(tvl_s *tvl, int nThreads = 0);
+
+// Read every file of the test vector dirs on nThreads and print the load rate
+void tvlLoadAll(const std::vector<fs::path> &dirs, int nThreads = 0);
+
+#endif // TVLOAD_H_
@@ -1,42 +1,83 @@
 #include "util.h"
 #include "encdl.h"
+#include "polarcfg.h"
+#include "trace.h"
+#include "tvbin.h"
+#include "tvload.h"
 #include <filesystem>
-#include <fstream>
 #include <iostream>
-#include <istream>
+#include <stdexcept>
+#include <string>
 #include <xtensor/xarray.hpp>
-#include <xtensor/xcsv.hpp>
+#include <xtensor/xbuilder.hpp>
 #include <xtensor/xio.hpp>
 #include <xtensor/xmanipulation.hpp>
 
 namespace fs = std::filesystem;
 
-void readParams(fs::path path, params_s *params) {
-    path /= "params.txt";
-    std::ifstream in_file;
-    in_file.open(path);
-    xt::xarray<int> params_f = xt::ravel(xt::load_csv<int>(in_file));
-    in_file.close();
-    std::cout << "params_f:" << std::endl << xt::transpose(params_f) << std::endl;
-    for (int i = 0; i < params_f.size(); ++i) {
-        switch (i) {
-        case 0:
-            params->A = params_f.at(i);
-            break;
-        case 1:
-            params->P = params_f.at(i);
-            break;
-        case 2:
-            params->K = params_f.at(i);
-            break;
-        case 3:
-            params->E = params_f.at(i);
-            break;
-        case 4:
-            params->N = params_f.at(i);
-            break;
-        default:
-            break;
+xt::xarray<int> readBits(fs::path path) {
+    // Converted binary container if present, text otherwise
+    const tvFile_s *bin;
+    if (const tvEntry_s *e = tvSharedEntry(path, &bin)) {
+        if (e->dtype == TV_INT32) {
+            auto v = tvAdaptInt(bin, e);
+            return xt::ravel(v);
         }
+        auto w = tvAdaptWords(bin, e);
+        size_t rows = e->ndim == 2 ? e->shape[0] : 1, cols = e->shape[e->ndim - 1];
+        xt::xarray<int> bits = xt::zeros<int>({rows * cols});
+        for (size_t r = 0; r < rows; ++r)
+            for (size_t c = 0; c < cols; ++c) {
+                uint64_t word = w(r, c >> 6);
+                bits(r * cols + c) = int((word >> (c & 63)) & 1);
+            }
+        return bits;
+    }
+    tvlArray_s text;
+    tvlRead(path, &text);
+    return tvlUnpack(&text);
+}
+
+void readPacked(fs::path path, int nBits, bitvec_s *bv) {
+    const tvFile_s *bin;
+    int64_t n;
+    if (const tvEntry_s *e = tvSharedEntry(path, &bin)) {
+        if (e->dtype != TV_BITS || e->ndim != 1)
+            throw std::runtime_error(path.string() + ": not a bit vector");
+        n = e->shape[0];
+        if (n != nBits)
+            throw std::runtime_error(path.string() + ": " + std::to_string(n) +
+                                     " bits, expected " + std::to_string(nBits));
+        auto w = tvAdaptWords(bin, e);
+        bv->words.assign(w.data(), w.data() + bvWords(nBits));
+    } else {
+        tvlArray_s text;
+        tvlRead(path, &text);
+        if (!text.bits)
+            throw std::runtime_error(path.string() + ": not a bit vector");
+        n = text.n;
+        bv->words = std::move(text.words);
     }
+    if (n != nBits)
+        throw std::runtime_error(path.string() + ": " + std::to_string(n) +
+                                 " bits, expected " + std::to_string(nBits));
+    bv->nBits = nBits;
+}
+
+uint16_t readRnti(fs::path path) {
+    bitvec_s bits;
+    readPacked(path, 16, &bits);
+    uint16_t rnti = 0;
+    for (int i = 0; i < 16; ++i)
+        rnti = uint16_t(rnti << 1 | bvGet(&bits, i));
+    return rnti;
+}
+
+void readParams(fs::path path, params_s *params) {
+    polarCfg_s cfg;
+    polarCfgRead(path, &cfg);
+    *params = cfg.params;
+    XT_TRACE(TRACE_DEBUG, TRACE_PARAMS,
+             "params: " << params->A << " " << params->P << " " << params->K << " "
+                        << params->E << " " << params->N << " " << params->link);
 }
\ No newline at end of file
@@ -1,11 +1,26 @@
 #ifndef UTIL_H_
 #define UTIL_H_
 
+#include "bitvec.h"
 #include "encdl.h"
+#include <cstdint>
 #include <filesystem>
+#include <xtensor/xarray.hpp>
 
 namespace fs = std::filesystem;
 
+// params.txt of a test vector directory, validated by polarCfgRead
 void readParams(fs::path path, params_s *params);
 
+// Flat int array of a test vector file, from the binary container when converted.
+// Containers are mapped once per run (tvShared) and read through views.
+xt::xarray<int> readBits(fs::path path);
+
+// Packed 0 / 1 file of nBits bits, words copied straight from the container or the
+// text scanner. Throws on other values or lengths.
+void readPacked(fs::path path, int nBits, bitvec_s *bv);
+
+// RNTI of a 16 bit file, MSB first
+uint16_t readRnti(fs::path path);
+
 #endif // UTIL_H_
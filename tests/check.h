@@ -0,0 +1,22 @@
+#ifndef CHECK_H_
+#define CHECK_H_
+
+#include <iostream>
+
+// Failure count of a test program, main returns checkFailures() != 0
+inline int &checkFailures() {
+    static int n = 0;
+    return n;
+}
+
+// Report a failed condition with its location and the streamed context
+#define CHECK(cond, what)                                                               \
+    do {                                                                                \
+        if (!(cond)) {                                                                  \
+            ++checkFailures();                                                          \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": " #cond ": " << what         \
+                      << std::endl;                                                     \
+        }                                                                               \
+    } while (0)
+
+#endif // CHECK_H_
@@ -0,0 +1,132 @@
+#include "arena.h"
+#include "batch.h"
+#include "bitvec.h"
+#include "check.h"
+#include "decdl.h"
+#include "plan.h"
+#include "polarcfg.h"
+#include "pool.h"
+#include "prof.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Steady state encoding and decoding must not touch the heap: after one warm-up call
+// per configuration, 1000 calls of each engine on the same buffers allocate nothing.
+// Profiled loops included, on the caller and on pool workers.
+
+#ifdef XT_EX_COUNT_ALLOC
+
+// The library counts, its operator new is linked in
+static int64_t testAllocs() { return allocCount(); }
+
+#else
+
+static std::atomic<int64_t> testNAllocs{0};
+
+static int64_t testAllocs() { return testNAllocs.load(std::memory_order_relaxed); }
+
+void *operator new(size_t n) {
+    testNAllocs.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t n) { return operator new(n); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+void operator delete[](void *p, size_t) noexcept { std::free(p); }
+
+#endif
+
+static const int nIter = 1000;
+
+// Allocations of nIter calls of fn after a warm-up call
+template <class F> static int64_t testSteady(F fn) {
+    fn();
+    int64_t n0 = testAllocs();
+    for (int i = 0; i < nIter; ++i)
+        fn();
+    return testAllocs() - n0;
+}
+
+int main() {
+    const int cfgs[][3] = {{12, 64, LINK_DL},   {40, 216, LINK_DL},  {100, 432, LINK_DL},
+                           {140, 864, LINK_DL}, {12, 78, LINK_UL},   {40, 300, LINK_UL},
+                           {360, 1200, LINK_UL}, {1000, 8000, LINK_UL}};
+    const int B = 100;
+    std::mt19937_64 rng(1);
+    for (const auto &c : cfgs) {
+        polarCfg_s cfg;
+        polarCfgMake(&cfg, c[0], c[1], c[2]);
+        const params_s *p = &cfg.params;
+        std::shared_ptr<const plan_s> plan = planGet(planCacheDefault(), &cfg);
+        int nInfo = bvWords(p->A), nRm = bvWords(p->E);
+        std::vector<uint64_t> info(B * nInfo), rm(B * nRm);
+        std::vector<uint16_t> rnti(B);
+        for (uint64_t &w : info)
+            w = rng();
+        for (uint16_t &r : rnti)
+            r = uint16_t(rng());
+
+        // Single codeword encoding
+        const plan_s *pl = plan.get();
+        int64_t n = testSteady([&] { planEncode(pl, info.data(), rnti[0], rm.data()); });
+        CHECK(n == 0, n << " allocations in planEncode, A " << p->A << " E " << p->E);
+        if (p->link != LINK_DL)
+            continue;
+
+        // Batched encoding and both decoder precisions
+        n = testSteady([&] { batchEncode(pl, B, info.data(), rnti.data(), rm.data()); });
+        CHECK(n == 0, n << " allocations in batchEncode, A " << p->A << " E " << p->E);
+        dec_s dec;
+        decCreate(&dec, plan);
+        std::vector<int16_t> llr16(p->E);
+        std::vector<int8_t> llr8(p->E);
+        for (int e = 0; e < p->E; ++e) {
+            llr16[e] = (rm[e >> 6] >> (e & 63)) & 1 ? -256 : 256;
+            llr8[e] = (rm[e >> 6] >> (e & 63)) & 1 ? -16 : 16;
+        }
+        for (int L : {1, 8}) {
+            uint16_t r = rnti[0];
+            n = testSteady([&] { decDecode16(&dec, llr16.data(), L, r, info.data()); });
+            CHECK(n == 0, n << " allocations in decDecode16, L " << L << " A " << p->A);
+            n = testSteady([&] { decDecode8(&dec, llr8.data(), L, r, info.data()); });
+            CHECK(n == 0, n << " allocations in decDecode8, L " << L << " A " << p->A);
+        }
+    }
+
+    // Profiled encoding on the caller and a pool worker, warmed up untimed so the
+    // first sample falls into the count. Both tasks count only once both threads run.
+    polarCfg_s cfg;
+    polarCfgMake(&cfg, 40, 216, LINK_DL);
+    std::shared_ptr<const plan_s> plan = planGet(planCacheDefault(), &cfg);
+    std::vector<uint64_t> info(2 * bvWords(cfg.params.A)), rm(2 * bvWords(cfg.params.E));
+    std::atomic<int> nReady{0};
+    int64_t nProf[2] = {};
+    profSet(true);
+    poolRun(2, 2, [&](int task, int) {
+        uint64_t *in = &info[task * bvWords(cfg.params.A)];
+        uint64_t *out = &rm[task * bvWords(cfg.params.E)];
+        nReady.fetch_add(1);
+        while (nReady.load() < 2)
+            std::this_thread::yield();
+        planEncode(plan.get(), in, 0, out);
+        int64_t n0 = testAllocs();
+        for (int i = 0; i < nIter; ++i) {
+            profTimer_s timer(PROF_ENCODE);
+            planEncode(plan.get(), in, 0, out);
+        }
+        nProf[task] = testAllocs() - n0;
+    });
+    profSet(false);
+    CHECK(nProf[0] == 0 && nProf[1] == 0,
+          nProf[0] << " / " << nProf[1] << " allocations in profiled planEncode");
+    return checkFailures() != 0;
+}
@@ -0,0 +1,86 @@
+#include "awgn.h"
+#include "bitvec.h"
+#include "check.h"
+#include "decdl.h"
+#include "plan.h"
+#include "polarcfg.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Decoder round trips: random payloads through planEncode, BPSK and AWGN at high SNR,
+// CA-SCL decoding with L = 1, 2 and 8 in both precisions. Every block must pass the
+// CRC with the sent info bits; the wrong RNTI and pure noise must fail it.
+
+static const int nBlocks = 100;
+static const float sigma = 0.35f; // Es/N0 9 dB
+
+static int16_t testQuant16(float llr) {
+    return int16_t(std::clamp(std::nearbyint(4.0f * llr), -1000.0f, 1000.0f));
+}
+
+static int8_t testQuant8(float llr) {
+    return int8_t(std::clamp(std::nearbyint(llr), -31.0f, 31.0f));
+}
+
+int main() {
+    const int cfgs[][2] = {{12, 64}, {40, 216}, {100, 432}, {140, 864}, {24, 1024}};
+    std::mt19937_64 rng(1);
+    for (const auto &ae : cfgs) {
+        polarCfg_s cfg;
+        polarCfgMake(&cfg, ae[0], ae[1], LINK_DL);
+        const params_s *p = &cfg.params;
+        dec_s dec;
+        decCreate(&dec, planGet(planCacheDefault(), &cfg));
+        int nInfo = bvWords(p->A);
+        std::vector<uint64_t> info(nInfo), rm(bvWords(p->E)), infoDec(nInfo);
+        std::vector<float> noise(p->E);
+        std::vector<int16_t> llr16(p->E);
+        std::vector<int8_t> llr8(p->E);
+        awgn_s awgn;
+        awgnInit(&awgn, 7, p->A * 65536 + p->E);
+
+        for (int L : {1, 2, 8}) {
+            int nCrcOk16 = 0, nCrcOk8 = 0, nDiff16 = 0, nDiff8 = 0, nFalse = 0;
+            for (int b = 0; b < nBlocks; ++b) {
+                // Payload, encoding and noisy LLRs, positive for bit 0
+                for (uint64_t &w : info)
+                    w = rng();
+                if (p->A & 63)
+                    info[nInfo - 1] &= (uint64_t{1} << (p->A & 63)) - 1;
+                uint16_t rnti = uint16_t(rng());
+                planEncode(dec.plan.get(), info.data(), rnti, rm.data());
+                awgnReal(&awgn, noise.data(), p->E, sigma);
+                for (int e = 0; e < p->E; ++e) {
+                    float x = 1.0f - 2.0f * float((rm[e >> 6] >> (e & 63)) & 1);
+                    float llr = 2.0f * (x + noise[e]) / (sigma * sigma);
+                    llr16[e] = testQuant16(llr);
+                    llr8[e] = testQuant8(llr);
+                }
+
+                // Both precisions must recover the payload
+                nCrcOk16 += decDecode16(&dec, llr16.data(), L, rnti, infoDec.data());
+                nDiff16 += infoDec != info;
+                nCrcOk8 += decDecode8(&dec, llr8.data(), L, rnti, infoDec.data());
+                nDiff8 += infoDec != info;
+
+                // Known bad CRCs, another RNTI and LLRs of noise alone
+                uint16_t other = rnti ^ 0x0101;
+                nFalse += decDecode16(&dec, llr16.data(), L, other, infoDec.data());
+                for (int e = 0; e < p->E; ++e)
+                    llr16[e] = testQuant16(2.0f * noise[e] / (sigma * sigma));
+                nFalse += decDecode16(&dec, llr16.data(), L, rnti, infoDec.data());
+            }
+            std::cout << "A " << p->A << " E " << p->E << " N " << p->N << " L " << L
+                      << ": crcOk " << nCrcOk16 << " / " << nCrcOk8 << ", nDiff "
+                      << nDiff16 << " / " << nDiff8 << ", false passes " << nFalse
+                      << std::endl;
+            CHECK(nCrcOk16 == nBlocks && nCrcOk8 == nBlocks, "CRC failures");
+            CHECK(nDiff16 == 0 && nDiff8 == 0, "decoded info bits differ");
+            CHECK(nFalse == 0, "bad CRC passed");
+        }
+    }
+    return checkFailures() != 0;
+}
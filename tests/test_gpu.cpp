@@ -0,0 +1,178 @@
+#include "batch.h"
+#include "bitvec.h"
+#include "check.h"
+#include "plan.h"
+#include "polarcfg.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// The CUDA kernel of batchgpu.cu against batchEncode, run on the CPU: one thread per
+// CUDA thread of a block, block barriers for __syncthreads and warp barriers around
+// the shuffles. Catches indexing, shuffle and bit order errors of the kernel, not the
+// behaviour of the device or of nvcc.
+
+// Reusable barrier of n threads. Yields instead of sleeping: the shuffles wait on it
+// thousands of times per block.
+typedef struct emuBarrier_s {
+    int n;
+    std::atomic<int> count;
+    std::atomic<uint32_t> gen;
+} emuBarrier_s;
+
+static void emuWait(emuBarrier_s *b) {
+    uint32_t gen = b->gen.load(std::memory_order_acquire);
+    if (b->count.fetch_add(1, std::memory_order_acq_rel) + 1 == b->n) {
+        b->count.store(0, std::memory_order_relaxed);
+        b->gen.store(gen + 1, std::memory_order_release);
+        return;
+    }
+    while (b->gen.load(std::memory_order_acquire) == gen)
+        std::this_thread::yield();
+}
+
+// Stand-ins for the CUDA runtime the kernel uses
+typedef struct CUstream_st *cudaStream_t;
+typedef int cudaError_t;
+
+#define BATCH_GPU_EMULATE
+#include "batchgpu.h"
+
+typedef struct emuDim_s {
+    int x;
+} emuDim_s;
+
+static thread_local emuDim_s threadIdx, blockIdx;
+static emuDim_s blockDim = {BATCH_GPU_BLOCK};
+static emuBarrier_s *emuBlock;                     // Threads of the block
+static emuBarrier_s *emuWarp[BATCH_GPU_BLOCK / 32];
+static uint32_t emuLanes[BATCH_GPU_BLOCK / 32][32]; // Values of a shuffle
+
+#define __global__
+#define __shared__
+
+static void __syncthreads() { emuWait(emuBlock); }
+
+static uint32_t emuShfl(uint32_t v, int src) {
+    int w = threadIdx.x >> 5;
+    emuLanes[w][threadIdx.x & 31] = v;
+    emuWait(emuWarp[w]);
+    uint32_t r = emuLanes[w][src & 31];
+    emuWait(emuWarp[w]);
+    return r;
+}
+
+static uint32_t __shfl_sync(unsigned, uint32_t v, int src) { return emuShfl(v, src); }
+
+static uint32_t __shfl_down_sync(unsigned, uint32_t v, int d) {
+    int lane = threadIdx.x & 31;
+    return emuShfl(v, lane + d < 32 ? lane + d : lane);
+}
+
+template <class T> static T __ldg(const T *p) { return *p; }
+
+static uint32_t __brev(uint32_t x) {
+    uint32_t r = 0;
+    for (int i = 0; i < 32; ++i)
+        r |= ((x >> i) & 1) << (31 - i);
+    return r;
+}
+
+using std::min;
+
+// Kept apart from a batchgpu.cu object of XT_EX_CUDA builds
+namespace {
+#include "batchgpu.cu"
+
+// Dynamic shared memory of the kernel, rows of the largest K
+uint64_t batchGpuRows[BATCH_GPU_BLOCK * (PLAN_K_MAX / 64 + 2)];
+} // namespace
+
+// Grid of B codewords, one block at a time
+static void emuLaunch(const batchGpuCode_s *code, int B, const uint64_t *info,
+                      const uint16_t *rnti, uint64_t *rm) {
+    if (code->nCWords > PLAN_K_MAX / 64 + 2)
+        throw std::runtime_error("shared rows too small");
+    for (int b = 0; b * BATCH_GPU_BLOCK < B; ++b) {
+        emuBarrier_s block{BATCH_GPU_BLOCK, {0}, {0}};
+        emuBarrier_s warps[BATCH_GPU_BLOCK / 32];
+        emuBlock = &block;
+        for (int w = 0; w < BATCH_GPU_BLOCK / 32; ++w) {
+            warps[w].n = 32;
+            warps[w].count = 0;
+            warps[w].gen = 0;
+            emuWarp[w] = &warps[w];
+        }
+        std::vector<std::thread> threads;
+        for (int t = 0; t < BATCH_GPU_BLOCK; ++t)
+            threads.emplace_back([&, t]() {
+                threadIdx.x = t;
+                blockIdx.x = b;
+                batchGpuKernel(*code, B, info, rnti, rm);
+            });
+        for (std::thread &t : threads)
+            t.join();
+    }
+}
+
+int main() {
+    std::mt19937_64 rng(3);
+    // Short codes, a full last word, CRC across a word edge, N = 512 and random ones
+    std::vector<std::pair<int, int>> sizes = {{12, 48}, {40, 108}, {64, 216},
+                                              {65, 184}, {134, 267}, {140, 864}};
+    while (sizes.size() < 10) {
+        int A = 1 + int(rng() % 140), E = (A + 24) * (8 + int(rng() % 57)) / 8;
+        polarCfg_s cfg;
+        try {
+            polarCfgMake(&cfg, A, E, LINK_DL);
+        } catch (const std::exception &) {
+            continue;
+        }
+        sizes.push_back({A, E});
+    }
+    for (const auto &ae : sizes) {
+        polarCfg_s cfg;
+        polarCfgMake(&cfg, ae.first, ae.second, LINK_DL);
+        std::shared_ptr<const plan_s> plan = planGet(planCacheDefault(), &cfg);
+        const params_s *p = &plan->params;
+        batchGpuCode_s code = {p->A,
+                               p->P,
+                               p->K,
+                               p->N,
+                               p->E,
+                               bvWords(p->A),
+                               bvWords(p->K + 1),
+                               bvWords(p->E),
+                               plan->crc->onesInit,
+                               plan->crc->polyRef,
+                               plan->crc->t[0],
+                               plan->uSrcCrc.data(),
+                               plan->rmIdx.data()};
+
+        // A full block and a partial one, info bits above A set
+        const int B = BATCH_GPU_BLOCK + 17;
+        std::vector<uint64_t> info(size_t(B) * code.nInfoWords);
+        std::vector<uint16_t> rnti(B);
+        for (uint64_t &w : info)
+            w = rng();
+        for (uint16_t &r : rnti)
+            r = uint16_t(rng());
+        std::vector<uint64_t> ref(size_t(B) * code.nRmWords);
+        std::vector<uint64_t> gpu(ref.size(), ~uint64_t{0});
+        batchEncode(plan.get(), B, info.data(), rnti.data(), ref.data());
+        emuLaunch(&code, B, info.data(), rnti.data(), gpu.data());
+        int nDiff = 0;
+        for (int b = 0; b < B; ++b)
+            nDiff += !std::equal(&ref[size_t(b) * code.nRmWords],
+                                 &ref[size_t(b + 1) * code.nRmWords],
+                                 &gpu[size_t(b) * code.nRmWords]);
+        CHECK(nDiff == 0, "A " << p->A << " E " << p->E << ": " << nDiff << " of " << B
+                                << " rows differ");
+    }
+    return checkFailures() != 0;
+}
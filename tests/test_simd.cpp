@@ -0,0 +1,97 @@
+#include "awgn.h"
+#include "check.h"
+#include "simd.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Dispatched kernels against the scalar ones, built with the library's flags: the
+// noise and the list decoder kernels must be bit exact for every instruction set, call
+// length and counter, and the noise of a stream must not depend on how it is split
+// into calls.
+
+int main() {
+    const simdKernels_s *scalar = simdFind(SIMD_SCALAR);
+    std::mt19937_64 rng(1);
+    for (simdIsa_e isa : {SIMD_NEON, SIMD_AVX2, SIMD_AVX512}) {
+        const simdKernels_s *k = simdFind(isa);
+        if (!k)
+            continue;
+        std::cout << k->name << std::endl;
+
+        // Every body and tail split, counters across the low word wrap
+        for (uint64_t ctr0 : {uint64_t{0}, uint64_t{0xffffffe0}, rng()})
+            for (int nBlocks = 0; nBlocks <= 40; ++nBlocks) {
+                uint32_t key[2] = {uint32_t(rng()), uint32_t(rng())};
+                uint64_t stream = rng();
+                float sigma = 0.5f + float(rng() % 1000) / 100;
+                std::vector<float> a(4 * nBlocks), b(4 * nBlocks);
+                scalar->gauss(key, stream, ctr0, nBlocks, sigma, a.data());
+                k->gauss(key, stream, ctr0, nBlocks, sigma, b.data());
+                CHECK(std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0,
+                      k->name << " gauss differs, nBlocks " << nBlocks << ", ctr "
+                              << ctr0);
+            }
+
+        // List decoder f and g at every node size, lanes shuffled, LLRs at the limits
+        const int w = SIMD_DEC_LANES;
+        for (int h = 1; h <= 256; h *= 2)
+            for (int rep = 0; rep < 4; ++rep) {
+                uint8_t lane[w], bits[256];
+                for (int p = 0; p < w; ++p)
+                    lane[p] = uint8_t(rng() % w);
+                for (int i = 0; i < h; ++i)
+                    bits[i] = uint8_t(rng());
+                std::vector<int16_t> a16(2 * h * w), c16(h * w), d16(h * w);
+                std::vector<int8_t> a8(2 * h * w), c8(h * w), d8(h * w);
+                for (int i = 0; i < 2 * h * w; ++i) {
+                    a16[i] = int16_t(int(rng() % 65535) - 32767);
+                    a8[i] = int8_t(int(rng() % 255) - 127);
+                }
+                scalar->decF16(a16.data(), h, lane, c16.data());
+                k->decF16(a16.data(), h, lane, d16.data());
+                CHECK(c16 == d16, k->name << " decF16 differs, h " << h);
+                scalar->decG16(a16.data(), bits, h, lane, c16.data());
+                k->decG16(a16.data(), bits, h, lane, d16.data());
+                CHECK(c16 == d16, k->name << " decG16 differs, h " << h);
+                scalar->decF8(a8.data(), h, lane, c8.data());
+                k->decF8(a8.data(), h, lane, d8.data());
+                CHECK(c8 == d8, k->name << " decF8 differs, h " << h);
+                scalar->decG8(a8.data(), bits, h, lane, c8.data());
+                k->decG8(a8.data(), bits, h, lane, d8.data());
+                CHECK(c8 == d8, k->name << " decG8 differs, h " << h);
+            }
+
+        // Sorting network rows: random comparators over 32 rows with repeated keys
+        for (int rep = 0; rep < 8; ++rep) {
+            uint8_t lo[64], hi[64];
+            for (int c = 0; c < 64; ++c) {
+                lo[c] = uint8_t(rng() % 32);
+                hi[c] = uint8_t(rng() % 32);
+            }
+            std::vector<uint32_t> x(32 * w), y;
+            for (uint32_t &v : x)
+                v = uint32_t(rng() % 4) << 30 | uint32_t(rng() % 4);
+            y = x;
+            scalar->decSort(x.data(), lo, hi, 64);
+            k->decSort(y.data(), lo, hi, 64);
+            CHECK(x == y, k->name << " decSort differs");
+        }
+    }
+
+    // One awgnReal call against the same stream in calls of 4 k + 4 floats
+    const int n = 4096;
+    awgn_s whole, parts;
+    awgnInit(&whole, 0x5eed, 3);
+    awgnInit(&parts, 0x5eed, 3);
+    std::vector<float> a(n), b(n);
+    awgnReal(&whole, a.data(), n, 1.0f);
+    for (int i = 0, m = 4; i < n; i += m, m = m % 44 + 4)
+        awgnReal(&parts, b.data() + i, std::min(m, n - i), 1.0f);
+    CHECK(std::memcmp(a.data(), b.data(), n * sizeof(float)) == 0,
+          "awgnReal depends on the call split");
+    return checkFailures() != 0;
+}